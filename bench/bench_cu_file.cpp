@@ -0,0 +1,40 @@
+#include "cu_bench.h"
+#include "libcu.h"
+#include "CuFile.h"
+#include "CuFormat.h"
+
+int main()
+{
+    char dirTemplate[] = "/tmp/bench_cu_file_XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    const std::string benchDir(dirTemplate);
+    const std::string smallPath(benchDir + "/small");
+    const std::string largePath(benchDir + "/large");
+    for (int idx = 0; idx < 64; idx++) {
+        CU::CreateFile(CU::Format("{}/entry{}", benchDir, idx), "0");
+    }
+    CU::CreateFile(largePath, std::string(256 * 1024, 'x'));
+    CU::CreateFile(smallPath, "");
+
+    CuBench::Run("WriteFile 16B", 50000, [&]() {
+        CU::WriteFile(smallPath, "1045936 28711 0\n");
+    });
+    CuBench::Run("ReadFile 16B", 50000, [&]() {
+        CuBench::DoNotOptimize(CU::ReadFile(smallPath));
+    });
+    CuBench::Run("ReadFile 256KB", 2000, [&]() {
+        CuBench::DoNotOptimize(CU::ReadFile(largePath));
+    });
+    CuBench::Run("ReadFile /proc/stat", 20000, [&]() {
+        CuBench::DoNotOptimize(CU::ReadFile("/proc/stat"));
+    });
+    CuBench::Run("ListFile 66 entries", 20000, [&]() {
+        CuBench::DoNotOptimize(CU::ListFile(benchDir));
+    });
+
+    CU::ExecCommand(CU::Format("rm -rf {}", benchDir));
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include "cu_bench.h"
+#include "CuFormat.h"
+
+int main()
+{
+    const std::string bpfPath("/sys/fs/bpf");
+    const std::string objectName("CuUtilMonitor");
+    const std::string mapName("cpu_util_map");
+
+    CuBench::Run("Format path", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format("{}/map_{}_{}", bpfPath, objectName, mapName));
+    });
+    CuBench::Run("Format CU_FMT path", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format(CU_FMT("{}/map_{}_{}"), bpfPath, objectName, mapName));
+    });
+    CuBench::Run("FormatTo path", 2000000, [&]() {
+        char buffer[128];
+        CU::FormatTo(buffer, sizeof(buffer), CU_FMT("{}/map_{}_{}"), bpfPath, objectName, mapName);
+        CuBench::DoNotOptimize(buffer);
+    });
+    CuBench::Run("FormatTemp path", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::FormatTemp(CU_FMT("{}/map_{}_{}"), bpfPath, objectName, mapName).data());
+    });
+    CuBench::Run("snprintf path", 2000000, [&]() {
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer), "%s/map_%s_%s", bpfPath.c_str(), objectName.c_str(), mapName.c_str());
+        CuBench::DoNotOptimize(buffer);
+    });
+    CuBench::Run("Format integers", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format("cpu{}: busy={}ns idle={}ns", 7, 123456789012ULL, 987654321ULL));
+    });
+    CuBench::Run("Format CU_FMT integers", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format(CU_FMT("cpu{}: busy={}ns idle={}ns"), 7, 123456789012ULL, 987654321ULL));
+    });
+    CuBench::Run("FormatTo integers", 2000000, [&]() {
+        char buffer[128];
+        CU::FormatTo(buffer, sizeof(buffer), CU_FMT("cpu{}: busy={}ns idle={}ns"), 7, 123456789012ULL, 987654321ULL);
+        CuBench::DoNotOptimize(buffer);
+    });
+    CuBench::Run("snprintf integers", 2000000, [&]() {
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer), "cpu%d: busy=%lluns idle=%lluns", 7, 123456789012ULL, 987654321ULL);
+        CuBench::DoNotOptimize(buffer);
+    });
+    CuBench::Run("Format float", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format("{}%", 42.125));
+    });
+    CuBench::Run("snprintf float", 2000000, [&]() {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%g%%", 42.125);
+        CuBench::DoNotOptimize(buffer);
+    });
+    CuBench::Run("Format indexed + max length", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format("{1:4}-{0}", mapName, objectName));
+    });
+    CuBench::Run("Format CU_FMT indexed + max length", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::Format(CU_FMT("{1:4}-{0}"), mapName, objectName));
+    });
+    CuBench::Run("CFormat", 2000000, [&]() {
+        CuBench::DoNotOptimize(CU::CFormat("%s/map_%s_%s", bpfPath.c_str(), objectName.c_str(), mapName.c_str()));
+    });
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "cu_bench.h"
+#include "libcu.h"
+#include "CuLogger.h"
+#include <vector>
+#include <thread>
+#include <unistd.h>
+
+// Producer side cost of one log line, the writer thread drains into a file in the background.
+int main()
+{
+    char pathTemplate[] = "/tmp/bench_cu_logger_XXXXXX";
+    int fd = mkstemp(pathTemplate);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+    CU::Logger::Create(CU::Logger::LogLevel::INFO, pathTemplate);
+
+    CuBench::Run("Logger filtered Debug", 5000000, []() {
+        CU::Logger::Debug(CU_FMT("sampled cpu{} busy={}ns"), 3, 1045936);
+    });
+    CuBench::Run("Logger Info 1 thread", 1000000, []() {
+        CU::Logger::Info(CU_FMT("sampled cpu{} busy={}ns"), 3, 1045936);
+    });
+    CU::Logger::Flush();
+    CuBench::Run("Logger Info runtime format", 1000000, []() {
+        CU::Logger::Info("sampled cpu{} busy={}ns", 3, 1045936);
+    });
+    CU::Logger::Flush();
+
+    for (int threadCount : {2, 4}) {
+        auto name = CU::Format(CU_FMT("Logger Info {} threads"), threadCount);
+        CuBench::Run(name.c_str(), 20, [threadCount]() {
+            std::vector<std::thread> threads{};
+            for (int thread = 0; thread < threadCount; thread++) {
+                threads.emplace_back([thread]() {
+                    for (int line = 0; line < 10000; line++) {
+                        CU::Logger::Info(CU_FMT("thread {} line {}"), thread, line);
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            CU::Logger::Flush();
+        }, 3);
+    }
+    std::printf("%llu lines dropped\n", static_cast<unsigned long long>(CU::Logger::DroppedLines()));
+
+    unlink(pathTemplate);
+    return 0;
+}
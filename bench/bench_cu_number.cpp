@@ -0,0 +1,73 @@
+#include "cu_bench.h"
+#include "CuFormat.h"
+#include <charconv>
+#include <vector>
+
+// Each run converts a batch of values so the branch predictor can not learn a single digit count.
+static constexpr size_t batchSize = 1024;
+
+template <typename _Ty>
+void BenchNumbers(const char* title, const std::vector<_Ty> &values, const char* printfFormat)
+{
+    char buffer[64];
+    size_t iterations = 2000;
+    CuBench::Run(CU::Format(CU_FMT("{} CU::FormatTo"), title).c_str(), iterations, [&]() {
+        for (const auto &value : values) {
+            CuBench::DoNotOptimize(CU::FormatTo(buffer, sizeof(buffer), CU_FMT("{}"), value));
+        }
+    });
+    CuBench::Run(CU::Format(CU_FMT("{} std::to_chars"), title).c_str(), iterations, [&]() {
+        for (const auto &value : values) {
+            CuBench::DoNotOptimize(std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+        }
+    });
+    CuBench::Run(CU::Format(CU_FMT("{} snprintf"), title).c_str(), iterations, [&]() {
+        for (const auto &value : values) {
+            CuBench::DoNotOptimize(std::snprintf(buffer, sizeof(buffer), printfFormat, value));
+        }
+    });
+}
+
+int main()
+{
+    std::vector<uint64_t> counters(batchSize);
+    std::vector<int64_t> deltas(batchSize);
+    std::vector<uint32_t> pids(batchSize);
+    std::vector<double> ratios(batchSize);
+    std::vector<uint64_t> masks(batchSize);
+    uint64_t state = 88172645463325252ULL;
+    for (size_t idx = 0; idx < batchSize; idx++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        counters[idx] = state >> (state % 64);
+        deltas[idx] = static_cast<int64_t>(state) >> (20 + state % 40);
+        pids[idx] = static_cast<uint32_t>(state % 65536);
+        ratios[idx] = static_cast<double>(state % 1000000) / 7919;
+        masks[idx] = state >> (state % 56);
+    }
+    std::printf("Per %zu values:\n", batchSize);
+
+    BenchNumbers("uint64", counters, "%llu");
+    BenchNumbers("int64", deltas, "%lld");
+    BenchNumbers("uint32", pids, "%u");
+    BenchNumbers("double", ratios, "%.17g");
+
+    char buffer[64];
+    CuBench::Run("hex CU::FormatTo", 2000, [&]() {
+        for (const auto &mask : masks) {
+            CuBench::DoNotOptimize(CU::FormatTo(buffer, sizeof(buffer), CU_FMT("{}"), CU::Hex(mask)));
+        }
+    });
+    CuBench::Run("hex std::to_chars", 2000, [&]() {
+        for (const auto &mask : masks) {
+            CuBench::DoNotOptimize(std::to_chars(buffer, buffer + sizeof(buffer), mask, 16).ptr);
+        }
+    });
+    CuBench::Run("hex snprintf", 2000, [&]() {
+        for (const auto &mask : masks) {
+            CuBench::DoNotOptimize(std::snprintf(buffer, sizeof(buffer), "%llx", static_cast<unsigned long long>(mask)));
+        }
+    });
+    return 0;
+}
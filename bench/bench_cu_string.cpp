@@ -0,0 +1,45 @@
+#include "cu_bench.h"
+#include "libcu.h"
+
+int main()
+{
+    const std::string statLine("cpu0 1045936 28711 813340 20935512 14271 101399 45021 0 0 0");
+    const std::string kernelVersion("5.10.198-android12-9-00085-g226a9632f13d");
+    const std::string progSection("bpf_prog_tracepoint/sched/sched_switch");
+    const std::string cpuList(" 0-7\n");
+
+    CuBench::Run("StrSplit(string, char)", 1000000, [&]() {
+        CuBench::DoNotOptimize(CU::StrSplit(statLine, ' '));
+    });
+    CuBench::Run("StrSplit(string, string)", 1000000, [&]() {
+        CuBench::DoNotOptimize(CU::StrSplit(statLine, std::string(" ")));
+    });
+    CuBench::Run("StrSplitAt(string, char, 4)", 1000000, [&]() {
+        CuBench::DoNotOptimize(CU::StrSplitAt(statLine, ' ', 4));
+    });
+    CuBench::Run("SubPrevStr(string, char)", 5000000, [&]() {
+        CuBench::DoNotOptimize(CU::SubPrevStr(kernelVersion, '-'));
+    });
+    CuBench::Run("SubPostStr(string, string)", 5000000, [&]() {
+        CuBench::DoNotOptimize(CU::SubPostStr(progSection, "bpf_prog_"));
+    });
+    CuBench::Run("SubRePostStr(string, char)", 5000000, [&]() {
+        CuBench::DoNotOptimize(CU::SubRePostStr(progSection, '/'));
+    });
+    CuBench::Run("Replace(string, '/', '_')", 5000000, [&]() {
+        CuBench::DoNotOptimize(CU::Replace(progSection, '/', '_'));
+    });
+    CuBench::Run("StrStartsWith", 20000000, [&]() {
+        CuBench::DoNotOptimize(CU::StrStartsWith(progSection, "bpf_prog_tracepoint"));
+    });
+    CuBench::Run("TrimStr", 5000000, [&]() {
+        CuBench::DoNotOptimize(CU::TrimStr(cpuList));
+    });
+    CuBench::Run("StrToInt", 20000000, [&]() {
+        CuBench::DoNotOptimize(CU::StrToInt("20935512"));
+    });
+    CuBench::Run("StrToULong", 20000000, [&]() {
+        CuBench::DoNotOptimize(CU::StrToULong("18446744073709551615"));
+    });
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Minimal benchmark harness for the cuprum utils, reports the best mean over a few rounds.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace CuBench
+{
+    template <typename _Ty>
+    inline void DoNotOptimize(const _Ty &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Iterations can be scaled with CU_BENCH_SCALE, e.g. CU_BENCH_SCALE=0.01 for a smoke run.
+    inline size_t Scaled(size_t iterations)
+    {
+        static const double scale = []() -> double {
+            const char* value = std::getenv("CU_BENCH_SCALE");
+            return (value != nullptr && std::atof(value) > 0) ? std::atof(value) : 1.0;
+        }();
+        auto scaled = static_cast<size_t>(iterations * scale);
+        return (scaled > 0) ? scaled : 1;
+    }
+
+    template <typename _Func>
+    inline double Run(const char* name, size_t iterations, _Func &&func, int rounds = 5)
+    {
+        iterations = Scaled(iterations);
+        double bestNs = 0;
+        for (int round = 0; round < rounds; round++) {
+            auto beginTime = std::chrono::steady_clock::now();
+            for (size_t idx = 0; idx < iterations; idx++) {
+                func();
+            }
+            auto duration = std::chrono::steady_clock::now() - beginTime;
+            double meanNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / iterations;
+            if (round == 0 || meanNs < bestNs) {
+                bestNs = meanNs;
+            }
+        }
+        std::printf("%-40s %12.1f ns/op  (%zu iterations, best of %d)\n", name, bestNs, iterations, rounds);
+        return bestNs;
+    }
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "utils/cu_libbpf.h"
+#include "utils/CuSched.h"
+#include "utils/CuLogger.h"
+#include <mutex>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+class AttachManager
+{
+    public:
+        enum class AttachType : uint8_t {TRACEPOINT, KPROBE, UPROBE, PERF_EVENT};
+
+        static const char* AttachTypeName(AttachType type) noexcept
+        {
+            switch (type) {
+                case AttachType::TRACEPOINT:
+                    return "tracepoint";
+                case AttachType::KPROBE:
+                    return "kprobe";
+                case AttachType::UPROBE:
+                    return "uprobe";
+                case AttachType::PERF_EVENT:
+                    return "perf_event";
+                default:
+                    break;
+            }
+            return "unknown";
+        }
+
+        AttachManager() : mtx_(), attachments_() { }
+        AttachManager(const AttachManager &other) = delete;
+        AttachManager &operator=(const AttachManager &other) = delete;
+
+        // The target is "category/name" for tracepoints, a symbol for kprobes and "path:offset" for uprobes.
+        bool attach(AttachType type, const std::string &progPath, const std::string &target)
+        {
+            std::unique_lock<std::mutex> lck(mtx_);
+            Attachment attachment{};
+            attachment.type = type;
+            attachment.progPath = progPath;
+            attachment.target = target;
+            attachment.cpu = -1;
+            attachment.boundCpu = -1;
+            attachment.perfFd = -1;
+            attachments_.emplace_back(attachment);
+            return attach_(attachments_.back(), GetOnlineCpus_());
+        }
+
+        // Opens one cpu-clock sampling event per cpu, offline cpus are attached once they come online.
+        bool attachCpuClock(const std::string &progPath, uint64_t samplePeriodNs, const CU::SchedAffinity &cpus)
+        {
+            std::unique_lock<std::mutex> lck(mtx_);
+            auto onlineCpus = GetOnlineCpus_();
+            bool attached = false;
+            for (const auto &cpu : cpus.cpuList()) {
+                Attachment attachment{};
+                attachment.type = AttachType::PERF_EVENT;
+                attachment.progPath = progPath;
+                attachment.target = "cpu_clock";
+                attachment.samplePeriodNs = samplePeriodNs;
+                attachment.cpu = cpu;
+                attachment.boundCpu = cpu;
+                attachment.perfFd = -1;
+                attachments_.emplace_back(attachment);
+                attached = attach_(attachments_.back(), onlineCpus) || attached;
+            }
+            return attached;
+        }
+
+        // Watches cpu hotplug uevents and re-checks every attachment at least once per checkIntervalMs.
+        void start(int checkIntervalMs)
+        {
+            std::thread mainLoop(std::bind(&AttachManager::mainLoop_, this, std::max(checkIntervalMs, 100)));
+            mainLoop.detach();
+        }
+
+    private:
+        struct Attachment
+        {
+            AttachType type;
+            std::string progPath;
+            std::string target;
+            uint64_t samplePeriodNs;
+            uint32_t progId;
+            int cpu;
+            int boundCpu;
+            int perfFd;
+        };
+
+        static CU::SchedAffinity GetOnlineCpus_()
+        {
+            return CU::SchedAffinity::FromCpuList(CU::ReadFile("/sys/devices/system/cpu/online"));
+        }
+
+        static int OpenUeventSocket_()
+        {
+            int ueventFd = socket(AF_NETLINK, (SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC), NETLINK_KOBJECT_UEVENT);
+            if (ueventFd < 0) {
+                return -1;
+            }
+            sockaddr_nl addr{};
+            addr.nl_family = AF_NETLINK;
+            addr.nl_groups = 1;
+            if (bind(ueventFd, reinterpret_cast<const sockaddr*>(std::addressof(addr)), sizeof(addr)) < 0) {
+                close(ueventFd);
+                return -1;
+            }
+            return ueventFd;
+        }
+
+        static bool IsCpuHotplugUevent_(const char* uevent)
+        {
+            return (std::strncmp(uevent, "online@/devices/system/cpu/cpu", 30) == 0 ||
+                std::strncmp(uevent, "offline@/devices/system/cpu/cpu", 31) == 0);
+        }
+
+        static int AttachOnCpu_(int progFd, const Attachment &attachment, int cpu)
+        {
+            switch (attachment.type) {
+                case AttachType::TRACEPOINT:
+                    return CU::Bpf::ProgAttachTracePoint(progFd, attachment.target, cpu);
+                case AttachType::KPROBE:
+                    return CU::Bpf::ProgAttachKprobe(progFd, attachment.target, cpu);
+                case AttachType::UPROBE:
+                    {
+                        auto separatorPos = attachment.target.rfind(':');
+                        if (separatorPos == std::string::npos) {
+                            return -1;
+                        }
+                        auto path = attachment.target.substr(0, separatorPos);
+                        auto offset = std::strtoull(attachment.target.c_str() + separatorPos + 1, nullptr, 0);
+                        return CU::Bpf::ProgAttachUprobe(progFd, path, offset, cpu);
+                    }
+                case AttachType::PERF_EVENT:
+                    return CU::Bpf::ProgAttachCpuClock(progFd, attachment.samplePeriodNs, cpu);
+                default:
+                    break;
+            }
+            return -1;
+        }
+
+        bool attach_(Attachment &attachment, const CU::SchedAffinity &onlineCpus)
+        {
+            int progFd = CU::Bpf::OpenObject(attachment.progPath);
+            if (progFd < 0) {
+                return false;
+            }
+            attachment.progId = CU::Bpf::GetProgId(progFd);
+            // A bpf program on a trace event runs on every cpu, the perf event only has to live on an online one.
+            // Sampling events count on their own cpu and are bound to it.
+            std::vector<int> cpus{};
+            if (attachment.boundCpu >= 0) {
+                if (onlineCpus.hasCpu(attachment.boundCpu)) {
+                    cpus.emplace_back(attachment.boundCpu);
+                }
+            } else {
+                cpus = onlineCpus.cpuList();
+                if (onlineCpus.hasCpu(attachment.cpu)) {
+                    cpus.insert(cpus.begin(), attachment.cpu);
+                }
+            }
+            for (const auto &cpu : cpus) {
+                int perfFd = AttachOnCpu_(progFd, attachment, cpu);
+                if (perfFd >= 0) {
+                    attachment.cpu = cpu;
+                    attachment.perfFd = perfFd;
+                    break;
+                }
+            }
+            close(progFd);
+            return (attachment.perfFd >= 0);
+        }
+
+        void detach_(Attachment &attachment)
+        {
+            if (attachment.perfFd >= 0) {
+                close(attachment.perfFd);
+                attachment.perfFd = -1;
+            }
+        }
+
+        bool isHealthy_(const Attachment &attachment, const CU::SchedAffinity &onlineCpus)
+        {
+            if (attachment.perfFd < 0 || !onlineCpus.hasCpu(attachment.cpu)) {
+                return false;
+            }
+            // Kernels without PERF_EVENT_IOC_QUERY_BPF can not tell, trust the fd in that case.
+            return (CU::Bpf::QueryProgAttached(attachment.perfFd, attachment.progId) != 0);
+        }
+
+        void reconcile_()
+        {
+            std::unique_lock<std::mutex> lck(mtx_);
+            auto onlineCpus = GetOnlineCpus_();
+            for (auto &attachment : attachments_) {
+                if (isHealthy_(attachment, onlineCpus)) {
+                    continue;
+                }
+                bool wasAttached = (attachment.perfFd >= 0);
+                detach_(attachment);
+                if (attachment.boundCpu >= 0 && !onlineCpus.hasCpu(attachment.boundCpu)) {
+                    if (wasAttached) {
+                        CU::Logger::Info(CU_FMT("Detached \"{}\" from {} \"{}\" of offline cpu{}."),
+                            attachment.progPath, AttachTypeName(attachment.type), attachment.target, attachment.boundCpu);
+                    }
+                    continue;
+                }
+                if (attach_(attachment, onlineCpus)) {
+                    CU::Logger::Info(CU_FMT("Re-attached \"{}\" to {} \"{}\" on cpu{}."),
+                        attachment.progPath, AttachTypeName(attachment.type), attachment.target, attachment.cpu);
+                } else if (wasAttached) {
+                    CU::Logger::Warn(CU_FMT("Lost the attachment of \"{}\" to {} \"{}\", will retry."),
+                        attachment.progPath, AttachTypeName(attachment.type), attachment.target);
+                }
+            }
+        }
+
+        void mainLoop_(int checkIntervalMs)
+        {
+            int ueventFd = OpenUeventSocket_();
+            if (ueventFd < 0) {
+                CU::Logger::Warn(CU_FMT("Failed to open uevent socket, cpu hotplug is polled every {}ms."), checkIntervalMs);
+            }
+            char uevent[4096]{};
+            auto nextCheckTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(checkIntervalMs);
+            for (;;) {
+                bool cpuHotplug = false;
+                if (ueventFd >= 0) {
+                    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        nextCheckTime - std::chrono::steady_clock::now()).count();
+                    pollfd pollFd{};
+                    pollFd.fd = ueventFd;
+                    pollFd.events = POLLIN;
+                    if (poll(std::addressof(pollFd), 1, static_cast<int>(std::max<int64_t>(timeout, 0))) > 0) {
+                        ssize_t len = 0;
+                        while ((len = recv(ueventFd, uevent, (sizeof(uevent) - 1), 0)) > 0) {
+                            uevent[len] = '\0';
+                            cpuHotplug = cpuHotplug || IsCpuHotplugUevent_(uevent);
+                        }
+                    }
+                } else {
+                    std::this_thread::sleep_until(nextCheckTime);
+                }
+                auto now = std::chrono::steady_clock::now();
+                if (cpuHotplug || now >= nextCheckTime) {
+                    reconcile_();
+                    nextCheckTime = now + std::chrono::milliseconds(checkIntervalMs);
+                }
+            }
+        }
+
+        std::mutex mtx_;
+        std::vector<Attachment> attachments_;
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "cu_util_history.h"
+#include <vector>
+#include <chrono>
+#include <cerrno>
+#include <sys/stat.h>
+
+// Appends utilization samples to a history file, see cu_util_history.h.
+// Records are batched in memory and written with one large write() when the buffer fills up or
+// flushIntervalMs passed, so the daemon issues a handful of syscalls per minute.
+class HistoryWriter
+{
+    public:
+        HistoryWriter() : fd_(-1), fileSize_(0), cpuCount_(0), flushInterval_(), lastFlushTime_(), hasPrevSample_(false), prevSample_(), buffer_(), bufferLen_(0) { }
+        HistoryWriter(const HistoryWriter &other) = delete;
+        HistoryWriter &operator=(const HistoryWriter &other) = delete;
+
+        ~HistoryWriter()
+        {
+            if (fd_ >= 0) {
+                flush();
+                close(fd_);
+            }
+        }
+
+        // Keeps the records of an existing history with the same layout. A history of another layout (e.g. a
+        // different cpu count) is moved to "<path>.old", a file that is not a history is never touched.
+        bool open(const std::string &path, uint32_t cpuCount, int flushIntervalMs)
+        {
+            cpuCount_ = cpuCount;
+            flushInterval_ = std::chrono::milliseconds(flushIntervalMs);
+            lastFlushTime_ = std::chrono::steady_clock::now();
+            buffer_.resize(BUFFER_SIZE);
+
+            cu_util_history_header header{};
+            header.magic = CU_UTIL_HISTORY_MAGIC;
+            header.version = CU_UTIL_HISTORY_VERSION;
+            header.header_size = sizeof(cu_util_history_header);
+            header.cpu_count = cpuCount;
+            header.clock_id = CLOCK_MONOTONIC;
+
+            fd_ = ::open(path.c_str(), (O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC), 0644);
+            struct stat st{};
+            if (fd_ < 0 || fstat(fd_, std::addressof(st)) < 0) {
+                return close_();
+            }
+            if (st.st_size > 0) {
+                cu_util_history_header fileHeader{};
+                if (pread(fd_, std::addressof(fileHeader), sizeof(fileHeader), 0) != sizeof(fileHeader) ||
+                    fileHeader.magic != CU_UTIL_HISTORY_MAGIC
+                ) {
+                    return close_();
+                }
+                if (std::memcmp(std::addressof(fileHeader), std::addressof(header), sizeof(header)) == 0) {
+                    // Drop a record cut short by a crash, new records would be unreachable behind it.
+                    cu_util_history_reader reader{};
+                    if (!cu_util_history_open(std::addressof(reader), path.c_str())) {
+                        return close_();
+                    }
+                    while (cu_util_history_next(std::addressof(reader)) != nullptr) { }
+                    auto validSize = static_cast<off_t>(reader.pos);
+                    bool truncated = (reader.pos < reader.size);
+                    cu_util_history_close(std::addressof(reader));
+                    if (truncated && ftruncate(fd_, validSize) < 0) {
+                        return close_();
+                    }
+                    fileSize_ = validSize;
+                    return true;
+                }
+                close(fd_);
+                fd_ = -1;
+                if (rename(path.c_str(), (path + ".old").c_str()) < 0) {
+                    return false;
+                }
+                fd_ = ::open(path.c_str(), (O_RDWR | O_CREAT | O_EXCL | O_APPEND | O_CLOEXEC), 0644);
+                if (fd_ < 0) {
+                    return false;
+                }
+            }
+            if (!write_(std::addressof(header), sizeof(header))) {
+                return close_();
+            }
+            fileSize_ = sizeof(header);
+            return true;
+        }
+
+        void append(const cu_util_query_reply &sample)
+        {
+            if (fd_ < 0 || sample.header.cpu_count != cpuCount_) {
+                return;
+            }
+            if (bufferLen_ + CU_UTIL_HISTORY_RECORD_MAX_LEN > buffer_.size()) {
+                flush();
+            }
+            bufferLen_ += cu_util_history_encode(buffer_.data() + bufferLen_, std::addressof(sample),
+                (hasPrevSample_ ? std::addressof(prevSample_) : nullptr));
+            std::memcpy(std::addressof(prevSample_), std::addressof(sample), sizeof(cu_util_query_reply));
+            hasPrevSample_ = true;
+
+            if (std::chrono::steady_clock::now() - lastFlushTime_ >= flushInterval_) {
+                flush();
+            }
+        }
+
+        void flush()
+        {
+            if (bufferLen_ > 0 && fd_ >= 0) {
+                if (write_(buffer_.data(), bufferLen_)) {
+                    fileSize_ += static_cast<off_t>(bufferLen_);
+                } else if (ftruncate(fd_, fileSize_) == 0) {
+                    // Readers stop at a partial record, cut it off and restart from a key record.
+                    hasPrevSample_ = false;
+                } else {
+                    close_();
+                }
+            }
+            bufferLen_ = 0;
+            lastFlushTime_ = std::chrono::steady_clock::now();
+        }
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+        bool close_()
+        {
+            if (fd_ >= 0) {
+                close(fd_);
+                fd_ = -1;
+            }
+            return false;
+        }
+
+        bool write_(const void* data, size_t len)
+        {
+            size_t writtenLen = 0;
+            while (writtenLen < len) {
+                auto ret = write(fd_, static_cast<const uint8_t*>(data) + writtenLen, len - writtenLen);
+                if (ret < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (ret <= 0) {
+                    return false;
+                }
+                writtenLen += static_cast<size_t>(ret);
+            }
+            return true;
+        }
+
+        int fd_;
+        off_t fileSize_;
+        uint32_t cpuCount_;
+        std::chrono::milliseconds flushInterval_;
+        std::chrono::steady_clock::time_point lastFlushTime_;
+        bool hasPrevSample_;
+        cu_util_query_reply prevSample_;
+        std::vector<uint8_t> buffer_;
+        size_t bufferLen_;
+};
@@ -0,0 +1,578 @@
+#pragma once
+
+#include "utils/cu_libbpf.h"
+#include "utils/cu_util_monitor.h"
+#include <unordered_map>
+#include <fcntl.h>
+
+// Readers of the optional statistics maps of cu_util_monitor.c. Opening fails if the pinned map is missing
+// (objects built before the map existed), a map whose program is not attached just reads zeros.
+
+// Per-cpu maps holding all the stats of a cpu in their only element.
+template <typename _Stats_Ty>
+class PerCpuStatsReader
+{
+    public:
+        PerCpuStatsReader() : mapFd_(-1), stats_() { }
+        PerCpuStatsReader(const PerCpuStatsReader &other) = delete;
+        PerCpuStatsReader &operator=(const PerCpuStatsReader &other) = delete;
+
+        bool open(const std::string &programName, const char* mapName)
+        {
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_{}"), programName, mapName));
+            stats_.resize(CU::Bpf::GetPossibleCpuCount());
+            return (mapFd_ >= 0);
+        }
+
+        // One lookup returns the stats of every possible cpu.
+        bool read()
+        {
+            return CU::Bpf::GetPerCpuElementValues(mapFd_, 0, stats_.data());
+        }
+
+        // Indexed by cpu, valid after a successful read().
+        const std::vector<_Stats_Ty> &stats() const noexcept
+        {
+            return stats_;
+        }
+
+    private:
+        int mapFd_;
+        std::vector<_Stats_Ty> stats_;
+};
+
+class IdleStateReader : public PerCpuStatsReader<cu_util_idle_stats>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_idle_stats_map");
+        }
+};
+
+class IrqStatsReader : public PerCpuStatsReader<cu_util_irq_stats>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_irq_stats_map");
+        }
+
+        static const char* SoftirqName(uint32_t vec) noexcept
+        {
+            static constexpr const char* softirqNames[CU_UTIL_MAX_SOFTIRQS] = {
+                "hi", "timer", "net_tx", "net_rx", "block", "irq_poll", "tasklet", "sched", "hrtimer", "rcu"
+            };
+            return (vec < CU_UTIL_MAX_SOFTIRQS) ? softirqNames[vec] : "unknown";
+        }
+};
+
+class ClassBusyReader : public PerCpuStatsReader<cu_util_class_busy>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_class_busy_ns_map");
+        }
+};
+
+class SliceHistReader : public PerCpuStatsReader<cu_util_slice_hist>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_slice_hist_map");
+        }
+
+        // The bucket holding the pct percentile of a histogram of CU_UTIL_SLICE_HIST_BUCKETS counts.
+        static uint32_t PercentileBucket(const uint64_t* counts, uint32_t pct) noexcept
+        {
+            uint64_t total = 0;
+            for (uint32_t bucket = 0; bucket < CU_UTIL_SLICE_HIST_BUCKETS; bucket++) {
+                total += counts[bucket];
+            }
+            uint64_t rank = (total * pct + 99) / 100;
+            uint64_t seen = 0;
+            for (uint32_t bucket = 0; bucket < CU_UTIL_SLICE_HIST_BUCKETS; bucket++) {
+                seen += counts[bucket];
+                if (seen >= rank && seen > 0) {
+                    return bucket;
+                }
+            }
+            return 0;
+        }
+
+        // "<4us" is the upper bound of a bucket, the last one is open ended.
+        static std::string FormatBucket(uint32_t bucket)
+        {
+            if (bucket >= CU_UTIL_SLICE_HIST_BUCKETS - 1) {
+                return CU::Format(CU_FMT(">={}us"), 1ULL << (CU_UTIL_SLICE_HIST_BUCKETS - 1));
+            }
+            return CU::Format(CU_FMT("<{}us"), 1ULL << (bucket + 1));
+        }
+};
+
+class SwitchCountReader : public PerCpuStatsReader<cu_util_switch_counts>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_switch_count_map");
+        }
+};
+
+class MigrationStatsReader : public PerCpuStatsReader<cu_util_migration_stats>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_migration_stats_map");
+        }
+
+        // Cpus of a cluster share a cpufreq policy, the id is the first cpu of the policy.
+        static int ClusterId(int cpu)
+        {
+            return CU::StrToInt(CU::ReadFile(CU::Format(CU_FMT("/sys/devices/system/cpu/cpu{}/cpufreq/related_cpus"), cpu)));
+        }
+};
+
+class WakeupCountReader : public PerCpuStatsReader<cu_util_wakeup_counts>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return PerCpuStatsReader::open(programName, "cpu_wakeup_count_map");
+        }
+};
+
+// Waker/wakee counts from wakeup_pair_map, with the wakee pids resolved to their tgids.
+class WakeupPairReader
+{
+    public:
+        WakeupPairReader() : mapFd_(-1), maxEntries_(0), keys_(), counts_() { }
+        WakeupPairReader(const WakeupPairReader &other) = delete;
+        WakeupPairReader &operator=(const WakeupPairReader &other) = delete;
+
+        bool open(const std::string &programName)
+        {
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_wakeup_pair_map"), programName));
+            bpf_map_info mapInfo{};
+            if (mapFd_ < 0 || !CU::Bpf::GetMapInfo(mapFd_, std::addressof(mapInfo))) {
+                return false;
+            }
+            maxEntries_ = mapInfo.max_entries;
+            return true;
+        }
+
+        // Wakeup counts keyed by PairKey(wakerTgid, wakeeTgid). Threads of one wakee process are merged,
+        // a wakee which already exited keeps its pid.
+        void read(std::unordered_map<uint64_t, uint64_t> &pairCounts)
+        {
+            pairCounts.clear();
+            std::unordered_map<uint32_t, uint32_t> tgids{};
+            auto count = CU::Bpf::GetHashElements(mapFd_, keys_, counts_, maxEntries_);
+            for (size_t idx = 0; idx < count; idx++) {
+                auto wakeePid = keys_[idx].wakee_pid;
+                auto iter = tgids.find(wakeePid);
+                if (iter == tgids.end()) {
+                    iter = tgids.emplace(wakeePid, GetTgid_(wakeePid)).first;
+                }
+                pairCounts[PairKey(keys_[idx].waker_tgid, iter->second)] += counts_[idx];
+            }
+        }
+
+        static constexpr uint64_t PairKey(uint32_t wakerTgid, uint32_t wakeeTgid) noexcept
+        {
+            return ((static_cast<uint64_t>(wakerTgid) << 32) | wakeeTgid);
+        }
+
+        // "comm[tgid]", or just the tgid once the process is gone.
+        static std::string ProcessName(uint32_t tgid)
+        {
+            auto comm = CU::ReadFile(CU::Format(CU_FMT("/proc/{}/comm"), tgid));
+            if (comm.size() > 0 && comm.back() == '\n') {
+                comm.pop_back();
+            }
+            return (comm.size() > 0) ? CU::Format(CU_FMT("{}[{}]"), comm, tgid) : CU::Format(CU_FMT("{}"), tgid);
+        }
+
+    private:
+        static uint32_t GetTgid_(uint32_t pid)
+        {
+            auto status = CU::ReadFile(CU::Format(CU_FMT("/proc/{}/status"), pid));
+            auto tgidPos = status.find("\nTgid:");
+            if (tgidPos == std::string::npos) {
+                return pid;
+            }
+            auto tgid = CU::StrToInt(status.substr(tgidPos + 6, 16));
+            return (tgid > 0) ? static_cast<uint32_t>(tgid) : pid;
+        }
+
+        int mapFd_;
+        uint32_t maxEntries_;
+        std::vector<cu_util_wakeup_key> keys_;
+        std::vector<uint64_t> counts_;
+};
+
+// "comm[pid]", comm is not terminated when it fills all 16 bytes.
+inline std::string FormatTaskName(uint32_t pid, const char (&comm)[16])
+{
+    return CU::Format(CU_FMT("{}[{}]"), std::string(comm, strnlen(comm, sizeof(comm))), pid);
+}
+
+// Hash maps keyed by pid.
+template <typename _Stats_Ty>
+class TaskMapReader
+{
+    public:
+        TaskMapReader() : mapFd_(-1), maxEntries_(0), pids_(), stats_() { }
+        TaskMapReader(const TaskMapReader &other) = delete;
+        TaskMapReader &operator=(const TaskMapReader &other) = delete;
+
+        bool open(const std::string &programName, const char* mapName)
+        {
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_{}"), programName, mapName));
+            bpf_map_info mapInfo{};
+            if (mapFd_ < 0 || !CU::Bpf::GetMapInfo(mapFd_, std::addressof(mapInfo))) {
+                return false;
+            }
+            maxEntries_ = mapInfo.max_entries;
+            return true;
+        }
+
+        // Returns the task count, pids() and stats() are parallel.
+        size_t read()
+        {
+            return CU::Bpf::GetHashElements(mapFd_, pids_, stats_, maxEntries_);
+        }
+
+        const std::vector<uint32_t> &pids() const noexcept
+        {
+            return pids_;
+        }
+
+        const std::vector<_Stats_Ty> &stats() const noexcept
+        {
+            return stats_;
+        }
+
+    private:
+        int mapFd_;
+        uint32_t maxEntries_;
+        std::vector<uint32_t> pids_;
+        std::vector<_Stats_Ty> stats_;
+};
+
+class TaskStatsReader : public TaskMapReader<cu_util_task_stats>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return TaskMapReader::open(programName, "task_stats_map");
+        }
+};
+
+class TaskOffCpuReader : public TaskMapReader<cu_util_task_offcpu>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return TaskMapReader::open(programName, "task_offcpu_map");
+        }
+};
+
+// Per-cpu aggregates of exited tasks, summed over all cpus.
+template <typename _Key_Ty>
+class ExitedStatsReader
+{
+    public:
+        ExitedStatsReader() : mapFd_(-1), maxEntries_(0), cpuCount_(0), keys_(), values_(), stats_() { }
+        ExitedStatsReader(const ExitedStatsReader &other) = delete;
+        ExitedStatsReader &operator=(const ExitedStatsReader &other) = delete;
+
+        bool open(const std::string &programName, const char* mapName)
+        {
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_{}"), programName, mapName));
+            bpf_map_info mapInfo{};
+            if (mapFd_ < 0 || !CU::Bpf::GetMapInfo(mapFd_, std::addressof(mapInfo))) {
+                return false;
+            }
+            maxEntries_ = mapInfo.max_entries;
+            cpuCount_ = CU::Bpf::GetPossibleCpuCount();
+            return true;
+        }
+
+        // Returns the group count, keys() and stats() are parallel.
+        size_t read()
+        {
+            auto count = CU::Bpf::GetHashElements(mapFd_, keys_, values_, maxEntries_, cpuCount_);
+            stats_.assign(count, cu_util_exited_stats{});
+            for (size_t idx = 0; idx < count; idx++) {
+                auto &stats = stats_[idx];
+                for (uint32_t cpu = 0; cpu < cpuCount_; cpu++) {
+                    const auto &value = values_[idx * cpuCount_ + cpu];
+                    stats.task_count += value.task_count;
+                    stats.switches.voluntary += value.switches.voluntary;
+                    stats.switches.involuntary += value.switches.involuntary;
+                    stats.migrations += value.migrations;
+                    for (uint32_t state = 0; state < CU_UTIL_MAX_OFFCPU_STATES; state++) {
+                        stats.off_cpu_ns[state] += value.off_cpu_ns[state];
+                    }
+                }
+            }
+            return count;
+        }
+
+        const std::vector<_Key_Ty> &keys() const noexcept
+        {
+            return keys_;
+        }
+
+        const std::vector<cu_util_exited_stats> &stats() const noexcept
+        {
+            return stats_;
+        }
+
+    private:
+        int mapFd_;
+        uint32_t maxEntries_;
+        uint32_t cpuCount_;
+        std::vector<_Key_Ty> keys_;
+        std::vector<cu_util_exited_stats> values_;
+        std::vector<cu_util_exited_stats> stats_;
+};
+
+class ExitedUidReader : public ExitedStatsReader<uint32_t>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return ExitedStatsReader::open(programName, "exited_uid_stats_map");
+        }
+};
+
+class ExitedCommReader : public ExitedStatsReader<cu_util_comm_key>
+{
+    public:
+        bool open(const std::string &programName)
+        {
+            return ExitedStatsReader::open(programName, "exited_comm_stats_map");
+        }
+};
+
+// Busy time per cgroup from cgroup_busy_ns_map. A cgroup v2 id is the inode number of the cgroup directory
+// (the low 32 bits before kernel 5.5), ids are resolved to paths by walking the hierarchy once and the walk
+// only runs again when unknown ids show up. Ids still unknown after a walk belong to deleted cgroups, their
+// entries are removed from the map so it does not fill up.
+class CgroupStatsReader
+{
+    public:
+        CgroupStatsReader() : 
+            mapFd_(-1), 
+            maxEntries_(0), 
+            cpuCount_(0), 
+            rootFd_(-1), 
+            handleType_(0), 
+            handleBytes_(0), 
+            cgroupRoot_(), 
+            cgroups_(), 
+            keys_(), 
+            values_() 
+        { }
+
+        CgroupStatsReader(const CgroupStatsReader &other) = delete;
+        CgroupStatsReader &operator=(const CgroupStatsReader &other) = delete;
+
+        bool open(const std::string &programName)
+        {
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_cgroup_busy_ns_map"), programName));
+            bpf_map_info mapInfo{};
+            if (mapFd_ < 0 || !CU::Bpf::GetMapInfo(mapFd_, std::addressof(mapInfo))) {
+                return false;
+            }
+            maxEntries_ = mapInfo.max_entries;
+            cpuCount_ = CU::Bpf::GetPossibleCpuCount();
+            openCgroupRoot_();
+            return true;
+        }
+
+        // Busy ns of every cgroup summed over all cpus, keyed by cgroup id.
+        void read(std::unordered_map<uint64_t, uint64_t> &busyTotals)
+        {
+            busyTotals.clear();
+            auto count = CU::Bpf::GetHashElements(mapFd_, keys_, values_, maxEntries_, cpuCount_);
+            for (size_t idx = 0; idx < count; idx++) {
+                uint64_t busyTotal = 0;
+                for (uint32_t cpu = 0; cpu < cpuCount_; cpu++) {
+                    busyTotal += values_[idx * cpuCount_ + cpu];
+                }
+                busyTotals[keys_[idx]] = busyTotal;
+            }
+            for (auto iter = busyTotals.begin(); iter != busyTotals.end();) {
+                auto cgroupIter = cgroups_.find(iter->first);
+                if (cgroupIter == cgroups_.end()) {
+                    auto cgroupPath = resolvePath_(iter->first);
+                    if (cgroupPath.size() == 0 && errno == ESTALE) {
+                        CU::Bpf::DeleteElement(mapFd_, iter->first);
+                        iter = busyTotals.erase(iter);
+                        continue;
+                    }
+                    cgroupIter = cgroups_.emplace(iter->first, CgroupEntry{std::move(cgroupPath), iter->second}).first;
+                } else if (cgroupIter->second.busyTotal == iter->second && isRemoved_(iter->first)) {
+                    // Only idle cgroups can have been removed, busy ones still had tasks.
+                    CU::Bpf::DeleteElement(mapFd_, iter->first);
+                    cgroups_.erase(cgroupIter);
+                    iter = busyTotals.erase(iter);
+                    continue;
+                }
+                cgroupIter->second.busyTotal = iter->second;
+                iter++;
+            }
+            // Entries evicted from the map are forgotten as well.
+            for (auto iter = cgroups_.begin(); iter != cgroups_.end();) {
+                if (busyTotals.count(iter->first) == 0) {
+                    iter = cgroups_.erase(iter);
+                } else {
+                    iter++;
+                }
+            }
+        }
+
+        // Relative to the cgroup2 mount, "/" is the root cgroup.
+        std::string path(uint64_t cgroupId) const
+        {
+            auto iter = cgroups_.find(cgroupId);
+            return (iter != cgroups_.end() && iter->second.path.size() > 0) ? iter->second.path : CU::Format(CU_FMT("cgroup#{}"), cgroupId);
+        }
+
+    private:
+        struct CgroupEntry
+        {
+            std::string path;
+            uint64_t busyTotal;
+        };
+
+        // The cgroup id is the kernfs file handle of the cgroup directory, the root's handle gives its type and size.
+        struct CgroupHandle
+        {
+            file_handle header;
+            uint64_t cgroupId;
+        };
+
+        static std::string FindCgroupRoot_()
+        {
+            for (const auto &line : CU::StrSplit(CU::ReadFile("/proc/self/mounts"), '\n')) {
+                auto fields = CU::StrSplit(line, ' ');
+                if (fields.size() > 2 && fields[2] == "cgroup2") {
+                    return fields[1];
+                }
+            }
+            return {};
+        }
+
+        void openCgroupRoot_()
+        {
+            cgroupRoot_ = FindCgroupRoot_();
+            if (cgroupRoot_.size() == 0) {
+                return;
+            }
+            CgroupHandle handle{};
+            handle.header.handle_bytes = sizeof(handle.cgroupId);
+            int mountId = 0;
+            if (name_to_handle_at(AT_FDCWD, cgroupRoot_.c_str(), std::addressof(handle.header), std::addressof(mountId), 0) < 0) {
+                return;
+            }
+            rootFd_ = ::open(cgroupRoot_.c_str(), (O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+            handleType_ = handle.header.handle_type;
+            handleBytes_ = handle.header.handle_bytes;
+        }
+
+        // -1 with errno ESTALE once the cgroup is gone.
+        int openCgroup_(uint64_t cgroupId) const
+        {
+            if (rootFd_ < 0) {
+                errno = ENOENT;
+                return -1;
+            }
+            CgroupHandle handle{};
+            handle.header.handle_type = handleType_;
+            handle.header.handle_bytes = handleBytes_;
+            handle.cgroupId = cgroupId;
+            return open_by_handle_at(rootFd_, std::addressof(handle.header), (O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        }
+
+        // Empty if the id cannot be resolved (errno ESTALE if the cgroup is gone), path() then falls back to the id.
+        std::string resolvePath_(uint64_t cgroupId) const
+        {
+            int fd = openCgroup_(cgroupId);
+            if (fd < 0) {
+                return {};
+            }
+            char fdPath[32]{};
+            char dirPath[PATH_MAX]{};
+            CU::FormatTo(fdPath, sizeof(fdPath), CU_FMT("/proc/self/fd/{}"), fd);
+            auto len = readlink(fdPath, dirPath, sizeof(dirPath) - 1);
+            close(fd);
+            if (len <= 0) {
+                return {};
+            }
+            std::string cgroupPath(dirPath, static_cast<size_t>(len));
+            if (cgroupPath.compare(0, cgroupRoot_.size(), cgroupRoot_) == 0) {
+                cgroupPath.erase(0, cgroupRoot_.size());
+            }
+            return (cgroupPath.size() > 0) ? cgroupPath : "/";
+        }
+
+        // Any other failure (no cgroup2 mount, missing privileges) keeps the entry.
+        bool isRemoved_(uint64_t cgroupId) const
+        {
+            int fd = openCgroup_(cgroupId);
+            if (fd >= 0) {
+                close(fd);
+                return false;
+            }
+            return (errno == ESTALE);
+        }
+
+        int mapFd_;
+        uint32_t maxEntries_;
+        uint32_t cpuCount_;
+        int rootFd_;
+        int handleType_;
+        uint32_t handleBytes_;
+        std::string cgroupRoot_;
+        std::unordered_map<uint64_t, CgroupEntry> cgroups_;
+        std::vector<uint64_t> keys_;
+        std::vector<uint64_t> values_;
+};
+
+// The busy totals of cu_util_monitor.c, indexed by cpu.
+class BusyTotalReader
+{
+    public:
+        BusyTotalReader() : mapFd_(-1), cpuCount_(0), busyTotal_() { }
+        BusyTotalReader(const BusyTotalReader &other) = delete;
+        BusyTotalReader &operator=(const BusyTotalReader &other) = delete;
+
+        bool open(const std::string &programName)
+        {
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_cpu_util_busy_total_ns_map"), programName));
+            cpuCount_ = std::min(CU::Bpf::GetPossibleCpuCount(), static_cast<uint32_t>(CU_UTIL_MAX_CPUS));
+            return (mapFd_ >= 0);
+        }
+
+        bool read()
+        {
+            return (CU::Bpf::GetArrayValues(mapFd_, busyTotal_, cpuCount_) == cpuCount_);
+        }
+
+        uint64_t busyTotal(size_t cpu) const noexcept
+        {
+            return (cpu < cpuCount_) ? busyTotal_[cpu] : 0;
+        }
+
+    private:
+        int mapFd_;
+        uint32_t cpuCount_;
+        uint64_t busyTotal_[CU_UTIL_MAX_CPUS];
+};
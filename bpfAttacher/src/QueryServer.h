@@ -0,0 +1,148 @@
+#pragma once
+
+#include "UtilSampler.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+
+class QueryServer
+{
+    public:
+        QueryServer(UtilSampler &sampler) : sampler_(sampler), listenFd_(-1), epollFd_(-1) { }
+        QueryServer(const QueryServer &other) = delete;
+        QueryServer &operator=(const QueryServer &other) = delete;
+
+        bool start(const std::string &socketPath)
+        {
+            sockaddr_un addr{};
+            if (socketPath.size() >= sizeof(addr.sun_path)) {
+                return false;
+            }
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, socketPath.data(), socketPath.size());
+
+            listenFd_ = socket(AF_UNIX, (SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC), 0);
+            if (listenFd_ < 0) {
+                return false;
+            }
+            unlink(socketPath.c_str());
+            if (bind(listenFd_, reinterpret_cast<const sockaddr*>(std::addressof(addr)), sizeof(addr)) < 0 ||
+                listen(listenFd_, MAX_CLIENTS) < 0
+            ) {
+                close(listenFd_);
+                listenFd_ = -1;
+                return false;
+            }
+            chmod(socketPath.c_str(), 0666);
+
+            epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+            if (epollFd_ < 0 || !watchFd_(listenFd_)) {
+                if (epollFd_ >= 0) {
+                    close(epollFd_);
+                }
+                close(listenFd_);
+                epollFd_ = -1;
+                listenFd_ = -1;
+                return false;
+            }
+
+            std::thread mainLoop(std::bind(&QueryServer::mainLoop_, this));
+            mainLoop.detach();
+            return true;
+        }
+
+    private:
+        static constexpr int MAX_CLIENTS = 64;
+
+        bool watchFd_(int fd)
+        {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            return (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, std::addressof(event)) == 0);
+        }
+
+        void acceptClients_()
+        {
+            for (;;) {
+                int clientFd = accept4(listenFd_, nullptr, nullptr, (SOCK_NONBLOCK | SOCK_CLOEXEC));
+                if (clientFd < 0) {
+                    break;
+                }
+                if (!watchFd_(clientFd)) {
+                    close(clientFd);
+                }
+            }
+        }
+
+        bool sendShmFd_(int clientFd)
+        {
+            int shmFd = sampler_.shmFd();
+            cu_util_query_reply_header header = {CU_UTIL_QUERY_MAGIC, CU_UTIL_QUERY_VERSION, CU_UTIL_QUERY_STATUS_OK};
+            if (shmFd < 0) {
+                header.status = CU_UTIL_QUERY_STATUS_NOT_READY;
+                return (send(clientFd, std::addressof(header), sizeof(header), (MSG_DONTWAIT | MSG_NOSIGNAL)) == sizeof(header));
+            }
+
+            char control[CMSG_SPACE(sizeof(int))]{};
+            iovec iov = {std::addressof(header), sizeof(header)};
+            msghdr msg{};
+            msg.msg_iov = std::addressof(iov);
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            auto cmsg = CMSG_FIRSTHDR(std::addressof(msg));
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), std::addressof(shmFd), sizeof(int));
+            return (sendmsg(clientFd, std::addressof(msg), (MSG_DONTWAIT | MSG_NOSIGNAL)) == sizeof(header));
+        }
+
+        bool handleRequest_(int clientFd, cu_util_query_reply* reply)
+        {
+            cu_util_query_request request{};
+            auto len = recv(clientFd, std::addressof(request), sizeof(request), MSG_DONTWAIT);
+            if (len <= 0) {
+                return (len < 0 && errno == EAGAIN);
+            }
+
+            size_t replyLen = sizeof(cu_util_query_reply_header);
+            if (len != sizeof(request) || request.magic != CU_UTIL_QUERY_MAGIC || request.version != CU_UTIL_QUERY_VERSION) {
+                reply->header = {CU_UTIL_QUERY_MAGIC, CU_UTIL_QUERY_VERSION, CU_UTIL_QUERY_STATUS_BAD_REQUEST};
+            } else if (request.command == CU_UTIL_QUERY_CMD_SHM_FD) {
+                return sendShmFd_(clientFd);
+            } else if (request.command != CU_UTIL_QUERY_CMD_SNAPSHOT) {
+                reply->header = {CU_UTIL_QUERY_MAGIC, CU_UTIL_QUERY_VERSION, CU_UTIL_QUERY_STATUS_BAD_REQUEST};
+            } else {
+                replyLen = sampler_.snapshot(reply);
+                if (replyLen == 0) {
+                    reply->header = {CU_UTIL_QUERY_MAGIC, CU_UTIL_QUERY_VERSION, CU_UTIL_QUERY_STATUS_NOT_READY};
+                    replyLen = sizeof(cu_util_query_reply_header);
+                }
+            }
+            return (send(clientFd, reply, replyLen, (MSG_DONTWAIT | MSG_NOSIGNAL)) == static_cast<ssize_t>(replyLen));
+        }
+
+        void mainLoop_()
+        {
+            epoll_event events[MAX_CLIENTS]{};
+            cu_util_query_reply reply{};
+            for (;;) {
+                int eventCount = epoll_wait(epollFd_, events, MAX_CLIENTS, -1);
+                for (int idx = 0; idx < eventCount; idx++) {
+                    int fd = events[idx].data.fd;
+                    if (fd == listenFd_) {
+                        acceptClients_();
+                    } else if ((events[idx].events & (EPOLLERR | EPOLLHUP)) != 0 || !handleRequest_(fd, &reply)) {
+                        epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+                        close(fd);
+                    }
+                }
+            }
+        }
+
+        UtilSampler &sampler_;
+        int listenFd_;
+        int epollFd_;
+};
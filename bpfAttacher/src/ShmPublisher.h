@@ -0,0 +1,55 @@
+#pragma once
+
+#include "cu_util_shm.h"
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <linux/memfd.h>
+
+class ShmPublisher
+{
+    public:
+        ShmPublisher() : shmFd_(-1), shm_(nullptr) { }
+        ShmPublisher(const ShmPublisher &other) = delete;
+        ShmPublisher &operator=(const ShmPublisher &other) = delete;
+
+        bool create(const char* name)
+        {
+            shmFd_ = static_cast<int>(syscall(__NR_memfd_create, name, (MFD_CLOEXEC | MFD_ALLOW_SEALING)));
+            if (shmFd_ < 0) {
+                return false;
+            }
+            if (ftruncate(shmFd_, CU_UTIL_SHM_SIZE) < 0) {
+                close(shmFd_);
+                shmFd_ = -1;
+                return false;
+            }
+            auto shm = mmap(nullptr, CU_UTIL_SHM_SIZE, (PROT_READ | PROT_WRITE), MAP_SHARED, shmFd_, 0);
+            if (shm == MAP_FAILED) {
+                close(shmFd_);
+                shmFd_ = -1;
+                return false;
+            }
+            shm_ = reinterpret_cast<cu_util_shm_region*>(shm);
+            // Readers get the same fd, keep them from resizing the region or mapping it writable.
+            if (fcntl(shmFd_, F_ADD_SEALS, (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL)) < 0) {
+                fcntl(shmFd_, F_ADD_SEALS, (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL));
+            }
+            return true;
+        }
+
+        void publish(const cu_util_query_reply* reply) noexcept
+        {
+            if (shm_ != nullptr) {
+                cu_util_shm_write(shm_, reply);
+            }
+        }
+
+        int fd() const noexcept
+        {
+            return shmFd_;
+        }
+
+    private:
+        int shmFd_;
+        cu_util_shm_region* shm_;
+};
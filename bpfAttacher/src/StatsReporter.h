@@ -0,0 +1,600 @@
+#pragma once
+
+#include "utils/CuLogger.h"
+#include "MonitorStats.h"
+#include <thread>
+#include <algorithm>
+
+// Logs the optional statistics of the monitor as deltas over every interval, groups whose maps are
+// missing are skipped.
+class StatsReporter
+{
+    public:
+        StatsReporter() :
+            intervalMs_(0), busyTotals_(), idleStates_(), irqStats_(), cgroupStats_(), classBusy_(), sliceHist_(), switchCounts_(), taskStats_(), migrationStats_(), clusterIds_(), wakeupCounts_(), wakeupPairs_(), taskOffCpu_(), exitedUids_(), exitedComms_(),
+            busyTotalsEnabled_(false), idleStatesEnabled_(false), irqStatsEnabled_(false), cgroupStatsEnabled_(false), classBusyEnabled_(false), sliceHistEnabled_(false),
+            switchCountsEnabled_(false), taskStatsEnabled_(false), migrationStatsEnabled_(false),
+            wakeupCountsEnabled_(false), wakeupPairsEnabled_(false), taskOffCpuEnabled_(false),
+            exitedUidsEnabled_(false), exitedCommsEnabled_(false) { }
+        StatsReporter(const StatsReporter &other) = delete;
+        StatsReporter &operator=(const StatsReporter &other) = delete;
+
+        // Returns false if the program has none of the statistics maps.
+        bool start(const std::string &programName, int intervalMs)
+        {
+            intervalMs_ = std::max(intervalMs, 1);
+            busyTotalsEnabled_ = busyTotals_.open(programName);
+            idleStatesEnabled_ = idleStates_.open(programName);
+            irqStatsEnabled_ = irqStats_.open(programName);
+            cgroupStatsEnabled_ = cgroupStats_.open(programName);
+            classBusyEnabled_ = classBusy_.open(programName);
+            sliceHistEnabled_ = sliceHist_.open(programName);
+            switchCountsEnabled_ = switchCounts_.open(programName);
+            taskStatsEnabled_ = taskStats_.open(programName);
+            migrationStatsEnabled_ = migrationStats_.open(programName);
+            wakeupCountsEnabled_ = wakeupCounts_.open(programName);
+            wakeupPairsEnabled_ = wakeupPairs_.open(programName);
+            taskOffCpuEnabled_ = taskOffCpu_.open(programName);
+            exitedUidsEnabled_ = exitedUids_.open(programName);
+            exitedCommsEnabled_ = exitedComms_.open(programName);
+            if (!idleStatesEnabled_ && !irqStatsEnabled_ && !cgroupStatsEnabled_ && !classBusyEnabled_ && !sliceHistEnabled_ && !switchCountsEnabled_ && !taskStatsEnabled_ &&
+                !migrationStatsEnabled_ && !wakeupCountsEnabled_ && !wakeupPairsEnabled_ &&
+                !taskOffCpuEnabled_ && !exitedUidsEnabled_ && !exitedCommsEnabled_) {
+                return false;
+            }
+            for (int cpu = 0; cpu < CU_UTIL_MAX_CPUS; cpu++) {
+                clusterIds_[cpu] = MigrationStatsReader::ClusterId(cpu);
+            }
+
+            std::thread mainLoop(std::bind(&StatsReporter::mainLoop_, this));
+            mainLoop.detach();
+            return true;
+        }
+
+    private:
+        // "12.3%" of total, with one decimal.
+        static std::string FormatShare_(uint64_t part, uint64_t total)
+        {
+            auto permille = (total > 0) ? (part * 1000 / total) : 0;
+            return CU::Format(CU_FMT("{}.{}%"), permille / 10, permille % 10);
+        }
+
+        void reportIdleStates_(std::vector<cu_util_idle_stats> &prevStats)
+        {
+            if (!idleStates_.read()) {
+                return;
+            }
+            const auto &stats = idleStates_.stats();
+            if (prevStats.size() == stats.size()) {
+                std::string states{};
+                for (size_t cpu = 0; cpu < stats.size(); cpu++) {
+                    states.clear();
+                    for (uint32_t state = 0; state < CU_UTIL_MAX_IDLE_STATES; state++) {
+                        auto entryCount = stats[cpu].entry_count[state] - prevStats[cpu].entry_count[state];
+                        auto residencyNs = stats[cpu].residency_ns[state] - prevStats[cpu].residency_ns[state];
+                        if (entryCount > 0 || residencyNs > 0) {
+                            states += CU::Format(CU_FMT(" state{}={}us/{}"), state, residencyNs / 1000, entryCount);
+                        }
+                    }
+                    if (states.size() > 0) {
+                        CU::Logger::Info(CU_FMT("Idle residency cpu{}:{}"), cpu, states);
+                    }
+                }
+            }
+            prevStats = stats;
+        }
+
+        // Task time is the busy time of the sched_switch accounting minus the interrupts it was charged with.
+        void reportIrqShares_(std::vector<cu_util_irq_stats> &prevStats, std::vector<uint64_t> &prevBusyTotals, uint64_t intervalNs)
+        {
+            if (!irqStats_.read()) {
+                return;
+            }
+            bool hasBusyTotals = (busyTotalsEnabled_ && busyTotals_.read());
+            const auto &stats = irqStats_.stats();
+            std::vector<uint64_t> busyTotals(stats.size(), 0);
+            for (size_t cpu = 0; cpu < stats.size() && hasBusyTotals; cpu++) {
+                busyTotals[cpu] = busyTotals_.busyTotal(cpu);
+            }
+            if (prevStats.size() == stats.size() && prevBusyTotals.size() == busyTotals.size()) {
+                std::string softirqs{};
+                for (size_t cpu = 0; cpu < stats.size(); cpu++) {
+                    auto hardirqNs = stats[cpu].hardirq_ns - prevStats[cpu].hardirq_ns;
+                    uint64_t softirqNs = 0;
+                    softirqs.clear();
+                    for (uint32_t vec = 0; vec < CU_UTIL_MAX_SOFTIRQS; vec++) {
+                        auto vecNs = stats[cpu].softirq_ns[vec] - prevStats[cpu].softirq_ns[vec];
+                        if (vecNs > 0) {
+                            softirqs += CU::Format(CU_FMT(" {}={}"), IrqStatsReader::SoftirqName(vec), FormatShare_(vecNs, intervalNs));
+                            softirqNs += vecNs;
+                        }
+                    }
+                    if (hardirqNs == 0 && softirqNs == 0) {
+                        continue;
+                    }
+                    auto idleIrqNs = stats[cpu].idle_irq_ns - prevStats[cpu].idle_irq_ns;
+                    auto busyIrqNs = (hardirqNs + softirqNs) - std::min(hardirqNs + softirqNs, idleIrqNs);
+                    auto busyNs = busyTotals[cpu] - prevBusyTotals[cpu];
+                    auto taskNs = (busyNs > busyIrqNs) ? (busyNs - busyIrqNs) : 0;
+                    auto taskShare = (hasBusyTotals && cpu < CU_UTIL_MAX_CPUS) ? FormatShare_(taskNs, intervalNs) : "n/a";
+                    CU::Logger::Info(CU_FMT("Cpu shares cpu{}: task={} irq={} softirq={}{}"), cpu, taskShare,
+                        FormatShare_(hardirqNs, intervalNs), FormatShare_(softirqNs, intervalNs), softirqs);
+                }
+            }
+            prevStats = stats;
+            prevBusyTotals = busyTotals;
+        }
+
+        // The busiest cgroups of the interval, 100% is one cpu.
+        void reportCgroups_(std::unordered_map<uint64_t, uint64_t> &prevTotals, bool hasPrevTotals, uint64_t intervalNs)
+        {
+            static constexpr size_t maxReportedCgroups = 8;
+
+            std::unordered_map<uint64_t, uint64_t> busyTotals{};
+            cgroupStats_.read(busyTotals);
+            if (hasPrevTotals) {
+                std::vector<std::pair<uint64_t, uint64_t>> busyDeltas{};
+                for (const auto &[cgroupId, busyTotal] : busyTotals) {
+                    auto iter = prevTotals.find(cgroupId);
+                    auto busyDelta = busyTotal - ((iter != prevTotals.end()) ? iter->second : 0);
+                    if (busyDelta > 0) {
+                        busyDeltas.emplace_back(busyDelta, cgroupId);
+                    }
+                }
+                auto reportedCount = std::min(busyDeltas.size(), maxReportedCgroups);
+                std::partial_sort(busyDeltas.begin(), busyDeltas.begin() + reportedCount, busyDeltas.end(), std::greater<>());
+                std::string cgroups{};
+                for (size_t idx = 0; idx < reportedCount; idx++) {
+                    cgroups += CU::Format(CU_FMT(" {}={}"), cgroupStats_.path(busyDeltas[idx].second), FormatShare_(busyDeltas[idx].first, intervalNs));
+                }
+                if (cgroups.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Cgroup busy ({} cgroups):{}"), busyTotals.size(), cgroups);
+                }
+            }
+            prevTotals = std::move(busyTotals);
+        }
+
+        // Busy time of rt, normal and background tasks, the fair capacity is what rt tasks left of the interval.
+        void reportClassBusy_(std::vector<cu_util_class_busy> &prevStats, uint64_t intervalNs)
+        {
+            if (!classBusy_.read()) {
+                return;
+            }
+            const auto &stats = classBusy_.stats();
+            if (prevStats.size() == stats.size()) {
+                for (size_t cpu = 0; cpu < stats.size(); cpu++) {
+                    uint64_t busyNs[CU_UTIL_MAX_PRIO_CLASSES]{};
+                    for (uint32_t prioClass = 0; prioClass < CU_UTIL_MAX_PRIO_CLASSES; prioClass++) {
+                        busyNs[prioClass] = stats[cpu].busy_ns[prioClass] - prevStats[cpu].busy_ns[prioClass];
+                    }
+                    if (busyNs[CU_UTIL_PRIO_CLASS_RT] == 0 && busyNs[CU_UTIL_PRIO_CLASS_NORMAL] == 0 && busyNs[CU_UTIL_PRIO_CLASS_BACKGROUND] == 0) {
+                        continue;
+                    }
+                    auto rtNs = std::min(busyNs[CU_UTIL_PRIO_CLASS_RT], intervalNs);
+                    CU::Logger::Info(CU_FMT("Class busy cpu{}: rt={} normal={} background={} fair capacity={}"), cpu,
+                        FormatShare_(busyNs[CU_UTIL_PRIO_CLASS_RT], intervalNs), FormatShare_(busyNs[CU_UTIL_PRIO_CLASS_NORMAL], intervalNs),
+                        FormatShare_(busyNs[CU_UTIL_PRIO_CLASS_BACKGROUND], intervalNs), FormatShare_(intervalNs - rtNs, intervalNs));
+                }
+            }
+            prevStats = stats;
+        }
+
+        // Percentiles of the run slices of the interval, merged over all cpus, for all tasks and per band.
+        void reportSliceHist_(std::vector<cu_util_slice_hist> &prevStats)
+        {
+            static constexpr const char* prioClassNames[CU_UTIL_MAX_PRIO_CLASSES] = {"rt", "normal", "background"};
+
+            if (!sliceHist_.read()) {
+                return;
+            }
+            const auto &stats = sliceHist_.stats();
+            if (prevStats.size() == stats.size()) {
+                uint64_t counts[CU_UTIL_MAX_PRIO_CLASSES + 1][CU_UTIL_SLICE_HIST_BUCKETS]{};
+                uint64_t sliceCounts[CU_UTIL_MAX_PRIO_CLASSES + 1]{};
+                for (size_t cpu = 0; cpu < stats.size(); cpu++) {
+                    for (uint32_t prioClass = 0; prioClass < CU_UTIL_MAX_PRIO_CLASSES; prioClass++) {
+                        for (uint32_t bucket = 0; bucket < CU_UTIL_SLICE_HIST_BUCKETS; bucket++) {
+                            auto count = stats[cpu].count[prioClass][bucket] - prevStats[cpu].count[prioClass][bucket];
+                            counts[prioClass][bucket] += count;
+                            counts[CU_UTIL_MAX_PRIO_CLASSES][bucket] += count;
+                            sliceCounts[prioClass] += count;
+                            sliceCounts[CU_UTIL_MAX_PRIO_CLASSES] += count;
+                        }
+                    }
+                }
+                std::string percentiles{};
+                for (uint32_t idx = 0; idx <= CU_UTIL_MAX_PRIO_CLASSES; idx++) {
+                    if (sliceCounts[idx] > 0) {
+                        percentiles += CU::Format(CU_FMT(" {}({})=p50{}/p90{}/p99{}"),
+                            (idx < CU_UTIL_MAX_PRIO_CLASSES) ? prioClassNames[idx] : "all", sliceCounts[idx],
+                            SliceHistReader::FormatBucket(SliceHistReader::PercentileBucket(counts[idx], 50)),
+                            SliceHistReader::FormatBucket(SliceHistReader::PercentileBucket(counts[idx], 90)),
+                            SliceHistReader::FormatBucket(SliceHistReader::PercentileBucket(counts[idx], 99)));
+                    }
+                }
+                if (percentiles.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Run slices:{}"), percentiles);
+                }
+            }
+            prevStats = stats;
+        }
+
+        void reportSwitchCounts_(std::vector<cu_util_switch_counts> &prevCounts)
+        {
+            if (!switchCounts_.read()) {
+                return;
+            }
+            const auto &counts = switchCounts_.stats();
+            if (prevCounts.size() == counts.size()) {
+                for (size_t cpu = 0; cpu < counts.size(); cpu++) {
+                    auto voluntary = counts[cpu].voluntary - prevCounts[cpu].voluntary;
+                    auto involuntary = counts[cpu].involuntary - prevCounts[cpu].involuntary;
+                    if (voluntary > 0 || involuntary > 0) {
+                        CU::Logger::Info(CU_FMT("Switches cpu{}: voluntary={} involuntary={} ({} preempted)"),
+                            cpu, voluntary, involuntary, FormatShare_(involuntary, voluntary + involuntary));
+                    }
+                }
+            }
+            prevCounts = counts;
+        }
+
+        // Concatenates formatEntry(delta, index) of the largest deltas, pairs are (delta, index).
+        template <typename _Format_Fn>
+        static std::string FormatTopTasks_(std::vector<std::pair<uint64_t, size_t>> &deltas, _Format_Fn formatEntry)
+        {
+            static constexpr size_t maxReportedTasks = 8;
+
+            auto reportedCount = std::min(deltas.size(), maxReportedTasks);
+            std::partial_sort(deltas.begin(), deltas.begin() + reportedCount, deltas.end(), std::greater<>());
+            std::string tasks{};
+            for (size_t idx = 0; idx < reportedCount; idx++) {
+                tasks += formatEntry(deltas[idx].first, deltas[idx].second);
+            }
+            return tasks;
+        }
+
+        // The most preempted tasks of the interval, a high rate means more runnable tasks than cpus,
+        // and the most migrated ones.
+        void reportTasks_(std::unordered_map<uint32_t, cu_util_task_stats> &prevStats, bool hasPrevStats)
+        {
+            auto taskCount = taskStats_.read();
+            const auto &pids = taskStats_.pids();
+            const auto &stats = taskStats_.stats();
+            std::unordered_map<uint32_t, cu_util_task_stats> taskStats{};
+            std::vector<std::pair<uint64_t, size_t>> involuntaryDeltas{};
+            std::vector<std::pair<uint64_t, size_t>> migrationDeltas{};
+            for (size_t idx = 0; idx < taskCount; idx++) {
+                taskStats[pids[idx]] = stats[idx];
+                auto iter = prevStats.find(pids[idx]);
+                bool hasPrev = (iter != prevStats.end());
+                // Pids reused after an exit or an LRU eviction start over.
+                auto prevInvoluntary = hasPrev ? std::min(iter->second.switches.involuntary, stats[idx].switches.involuntary) : 0;
+                auto prevMigrations = hasPrev ? std::min(iter->second.migrations, stats[idx].migrations) : 0;
+                auto involuntary = stats[idx].switches.involuntary - prevInvoluntary;
+                auto migrations = stats[idx].migrations - prevMigrations;
+                if (involuntary > 0) {
+                    involuntaryDeltas.emplace_back(involuntary, idx);
+                }
+                if (migrations > 0) {
+                    migrationDeltas.emplace_back(migrations, idx);
+                }
+            }
+            if (hasPrevStats) {
+                const auto formatCount = [&pids, &stats](uint64_t delta, size_t idx) -> std::string {
+                    return CU::Format(CU_FMT(" {}={}"), FormatTaskName(pids[idx], stats[idx].comm), delta);
+                };
+                auto preemptedTasks = FormatTopTasks_(involuntaryDeltas, formatCount);
+                if (preemptedTasks.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Preempted tasks ({} tracked):{}"), taskCount, preemptedTasks);
+                }
+                auto migratedTasks = FormatTopTasks_(migrationDeltas, formatCount);
+                if (migratedTasks.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Migrated tasks:{}"), migratedTasks);
+                }
+            }
+            prevStats = std::move(taskStats);
+        }
+
+        // Migration counts summed over the cpus that moved the tasks, with the busiest (src, dst) pairs.
+        void reportMigrations_(std::vector<uint64_t> &prevCounts)
+        {
+            static constexpr size_t maxReportedPairs = 8;
+
+            if (!migrationStats_.read()) {
+                return;
+            }
+            std::vector<uint64_t> counts(CU_UTIL_MAX_CPUS * CU_UTIL_MAX_CPUS, 0);
+            for (const auto &stats : migrationStats_.stats()) {
+                for (size_t src = 0; src < CU_UTIL_MAX_CPUS; src++) {
+                    for (size_t dst = 0; dst < CU_UTIL_MAX_CPUS; dst++) {
+                        counts[src * CU_UTIL_MAX_CPUS + dst] += stats.count[src][dst];
+                    }
+                }
+            }
+            if (prevCounts.size() == counts.size()) {
+                uint64_t total = 0;
+                uint64_t crossCluster = 0;
+                std::vector<std::pair<uint64_t, size_t>> pairDeltas{};
+                for (size_t idx = 0; idx < counts.size(); idx++) {
+                    auto delta = counts[idx] - prevCounts[idx];
+                    if (delta > 0) {
+                        total += delta;
+                        if (clusterIds_[idx / CU_UTIL_MAX_CPUS] != clusterIds_[idx % CU_UTIL_MAX_CPUS]) {
+                            crossCluster += delta;
+                        }
+                        pairDeltas.emplace_back(delta, idx);
+                    }
+                }
+                auto reportedCount = std::min(pairDeltas.size(), maxReportedPairs);
+                std::partial_sort(pairDeltas.begin(), pairDeltas.begin() + reportedCount, pairDeltas.end(), std::greater<>());
+                std::string pairs{};
+                for (size_t idx = 0; idx < reportedCount; idx++) {
+                    auto pair = pairDeltas[idx].second;
+                    pairs += CU::Format(CU_FMT(" cpu{}->cpu{}={}"), pair / CU_UTIL_MAX_CPUS, pair % CU_UTIL_MAX_CPUS, pairDeltas[idx].first);
+                }
+                if (total > 0) {
+                    CU::Logger::Info(CU_FMT("Migrations: total={} cross-cluster={} ({}){}"), total, crossCluster,
+                        FormatShare_(crossCluster, total), pairs);
+                }
+            }
+            prevCounts = std::move(counts);
+        }
+
+        void reportWakeupCounts_(std::vector<cu_util_wakeup_counts> &prevCounts)
+        {
+            if (!wakeupCounts_.read()) {
+                return;
+            }
+            const auto &counts = wakeupCounts_.stats();
+            if (prevCounts.size() == counts.size()) {
+                for (size_t cpu = 0; cpu < counts.size(); cpu++) {
+                    auto local = counts[cpu].local - prevCounts[cpu].local;
+                    auto remote = counts[cpu].remote - prevCounts[cpu].remote;
+                    if (local > 0 || remote > 0) {
+                        CU::Logger::Info(CU_FMT("Wakeups cpu{}: local={} remote={} ({} remote)"),
+                            cpu, local, remote, FormatShare_(remote, local + remote));
+                    }
+                }
+            }
+            prevCounts = counts;
+        }
+
+        // The processes waking each other most often during the interval, candidates for sharing a cluster.
+        void reportWakeupPairs_(std::unordered_map<uint64_t, uint64_t> &prevCounts, bool hasPrevCounts)
+        {
+            static constexpr size_t maxReportedPairs = 8;
+
+            std::unordered_map<uint64_t, uint64_t> pairCounts{};
+            wakeupPairs_.read(pairCounts);
+            if (hasPrevCounts) {
+                std::vector<std::pair<uint64_t, uint64_t>> pairDeltas{};
+                for (const auto &[pairKey, count] : pairCounts) {
+                    auto iter = prevCounts.find(pairKey);
+                    auto delta = count - ((iter != prevCounts.end()) ? std::min(iter->second, count) : 0);
+                    if (delta > 0) {
+                        pairDeltas.emplace_back(delta, pairKey);
+                    }
+                }
+                auto reportedCount = std::min(pairDeltas.size(), maxReportedPairs);
+                std::partial_sort(pairDeltas.begin(), pairDeltas.begin() + reportedCount, pairDeltas.end(), std::greater<>());
+                std::string pairs{};
+                for (size_t idx = 0; idx < reportedCount; idx++) {
+                    auto pairKey = pairDeltas[idx].second;
+                    pairs += CU::Format(CU_FMT(" {}->{}={}"), WakeupPairReader::ProcessName(static_cast<uint32_t>(pairKey >> 32)),
+                        WakeupPairReader::ProcessName(static_cast<uint32_t>(pairKey)), pairDeltas[idx].first);
+                }
+                if (pairs.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Wakeup pairs ({} pairs):{}"), pairCounts.size(), pairs);
+                }
+            }
+            prevCounts = std::move(pairCounts);
+        }
+
+        // Off-cpu time of the interval per state, with the tasks waiting longest for a cpu and for I/O.
+        void reportOffCpu_(std::unordered_map<uint32_t, cu_util_task_offcpu> &prevStats, bool hasPrevStats)
+        {
+            static constexpr const char* stateNames[CU_UTIL_MAX_OFFCPU_STATES] = {"runnable", "sleep", "blocked", "other"};
+
+            auto taskCount = taskOffCpu_.read();
+            const auto &pids = taskOffCpu_.pids();
+            const auto &stats = taskOffCpu_.stats();
+            std::unordered_map<uint32_t, cu_util_task_offcpu> taskStats{};
+            uint64_t offCpuNs[CU_UTIL_MAX_OFFCPU_STATES]{};
+            std::vector<std::pair<uint64_t, size_t>> runnableDeltas{};
+            std::vector<std::pair<uint64_t, size_t>> blockedDeltas{};
+            for (size_t idx = 0; idx < taskCount; idx++) {
+                taskStats[pids[idx]] = stats[idx];
+                auto iter = prevStats.find(pids[idx]);
+                for (uint32_t state = 0; state < CU_UTIL_MAX_OFFCPU_STATES; state++) {
+                    // Pids reused after an LRU eviction start over.
+                    auto prevNs = (iter != prevStats.end()) ? std::min(iter->second.off_cpu_ns[state], stats[idx].off_cpu_ns[state]) : 0;
+                    auto deltaNs = stats[idx].off_cpu_ns[state] - prevNs;
+                    offCpuNs[state] += deltaNs;
+                    if (deltaNs > 0 && state == CU_UTIL_OFFCPU_RUNNABLE) {
+                        runnableDeltas.emplace_back(deltaNs, idx);
+                    } else if (deltaNs > 0 && state == CU_UTIL_OFFCPU_UNINTERRUPTIBLE) {
+                        blockedDeltas.emplace_back(deltaNs, idx);
+                    }
+                }
+            }
+            if (hasPrevStats && taskCount > 0) {
+                std::string states{};
+                for (uint32_t state = 0; state < CU_UTIL_MAX_OFFCPU_STATES; state++) {
+                    states += CU::Format(CU_FMT(" {}={}ms"), stateNames[state], offCpuNs[state] / 1000000);
+                }
+                CU::Logger::Info(CU_FMT("Off-cpu time ({} tasks):{}"), taskCount, states);
+                const auto formatMs = [&pids, &stats](uint64_t deltaNs, size_t idx) -> std::string {
+                    return CU::Format(CU_FMT(" {}={}ms"), FormatTaskName(pids[idx], stats[idx].comm), deltaNs / 1000000);
+                };
+                auto runnableTasks = FormatTopTasks_(runnableDeltas, formatMs);
+                if (runnableTasks.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Runqueue wait tasks:{}"), runnableTasks);
+                }
+                auto blockedTasks = FormatTopTasks_(blockedDeltas, formatMs);
+                if (blockedTasks.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Blocked tasks:{}"), blockedTasks);
+                }
+            }
+            prevStats = std::move(taskStats);
+        }
+
+        // The uids or comms whose tasks exited most during the interval, with the counters those tasks left.
+        template <typename _Reader_Ty, typename _Name_Fn>
+        static void ReportExited_(
+            _Reader_Ty &reader, const char* groupName, std::unordered_map<std::string, cu_util_exited_stats> &prevStats, bool hasPrevStats,
+            _Name_Fn nameOf)
+        {
+            auto groupCount = reader.read();
+            const auto &keys = reader.keys();
+            const auto &stats = reader.stats();
+            std::unordered_map<std::string, cu_util_exited_stats> groupStats{};
+            std::vector<cu_util_exited_stats> deltas(groupCount, cu_util_exited_stats{});
+            std::vector<std::pair<uint64_t, size_t>> taskCountDeltas{};
+            for (size_t idx = 0; idx < groupCount; idx++) {
+                auto name = nameOf(keys[idx]);
+                auto iter = prevStats.find(name);
+                // Groups evicted from the LRU map start over.
+                if (iter != prevStats.end() && iter->second.task_count <= stats[idx].task_count) {
+                    const auto &prev = iter->second;
+                    deltas[idx].task_count = stats[idx].task_count - prev.task_count;
+                    deltas[idx].switches.voluntary = stats[idx].switches.voluntary - prev.switches.voluntary;
+                    deltas[idx].switches.involuntary = stats[idx].switches.involuntary - prev.switches.involuntary;
+                    for (uint32_t state = 0; state < CU_UTIL_MAX_OFFCPU_STATES; state++) {
+                        deltas[idx].off_cpu_ns[state] = stats[idx].off_cpu_ns[state] - prev.off_cpu_ns[state];
+                    }
+                } else {
+                    deltas[idx] = stats[idx];
+                }
+                if (deltas[idx].task_count > 0) {
+                    taskCountDeltas.emplace_back(deltas[idx].task_count, idx);
+                }
+                groupStats[name] = stats[idx];
+            }
+            if (hasPrevStats) {
+                auto groups = FormatTopTasks_(taskCountDeltas, [&](uint64_t taskCount, size_t idx) -> std::string {
+                    const auto &delta = deltas[idx];
+                    uint64_t offCpuNs = 0;
+                    for (uint32_t state = 0; state < CU_UTIL_MAX_OFFCPU_STATES; state++) {
+                        offCpuNs += delta.off_cpu_ns[state];
+                    }
+                    return CU::Format(CU_FMT(" {}={} tasks/{} switches/{}ms off-cpu"), nameOf(keys[idx]), taskCount,
+                        delta.switches.voluntary + delta.switches.involuntary, offCpuNs / 1000000);
+                });
+                if (groups.size() > 0) {
+                    CU::Logger::Info(CU_FMT("Exited tasks by {}:{}"), groupName, groups);
+                }
+            }
+            prevStats = std::move(groupStats);
+        }
+
+        void mainLoop_()
+        {
+            std::vector<cu_util_idle_stats> prevIdleStats{};
+            std::vector<cu_util_irq_stats> prevIrqStats{};
+            std::vector<uint64_t> prevBusyTotals{};
+            std::unordered_map<uint64_t, uint64_t> prevCgroupTotals{};
+            bool hasPrevCgroupTotals = false;
+            std::vector<cu_util_class_busy> prevClassBusy{};
+            std::vector<cu_util_slice_hist> prevSliceHist{};
+            std::vector<cu_util_switch_counts> prevSwitchCounts{};
+            std::unordered_map<uint32_t, cu_util_task_stats> prevTaskStats{};
+            bool hasPrevTaskStats = false;
+            std::vector<uint64_t> prevMigrationCounts{};
+            std::vector<cu_util_wakeup_counts> prevWakeupCounts{};
+            std::unordered_map<uint64_t, uint64_t> prevWakeupPairs{};
+            bool hasPrevWakeupPairs = false;
+            std::unordered_map<uint32_t, cu_util_task_offcpu> prevOffCpu{};
+            bool hasPrevOffCpu = false;
+            std::unordered_map<std::string, cu_util_exited_stats> prevExitedUids{};
+            std::unordered_map<std::string, cu_util_exited_stats> prevExitedComms{};
+            bool hasPrevExited = false;
+            auto prevTime = std::chrono::steady_clock::now();
+            auto nextTime = prevTime;
+            for (;;) {
+                auto now = std::chrono::steady_clock::now();
+                auto intervalNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - prevTime).count());
+                prevTime = now;
+                if (idleStatesEnabled_) {
+                    reportIdleStates_(prevIdleStats);
+                }
+                if (irqStatsEnabled_) {
+                    reportIrqShares_(prevIrqStats, prevBusyTotals, intervalNs);
+                }
+                if (cgroupStatsEnabled_) {
+                    reportCgroups_(prevCgroupTotals, hasPrevCgroupTotals, intervalNs);
+                    hasPrevCgroupTotals = true;
+                }
+                if (classBusyEnabled_) {
+                    reportClassBusy_(prevClassBusy, intervalNs);
+                }
+                if (sliceHistEnabled_) {
+                    reportSliceHist_(prevSliceHist);
+                }
+                if (switchCountsEnabled_) {
+                    reportSwitchCounts_(prevSwitchCounts);
+                }
+                if (taskStatsEnabled_) {
+                    reportTasks_(prevTaskStats, hasPrevTaskStats);
+                    hasPrevTaskStats = true;
+                }
+                if (migrationStatsEnabled_) {
+                    reportMigrations_(prevMigrationCounts);
+                }
+                if (wakeupCountsEnabled_) {
+                    reportWakeupCounts_(prevWakeupCounts);
+                }
+                if (wakeupPairsEnabled_) {
+                    reportWakeupPairs_(prevWakeupPairs, hasPrevWakeupPairs);
+                    hasPrevWakeupPairs = true;
+                }
+                if (taskOffCpuEnabled_) {
+                    reportOffCpu_(prevOffCpu, hasPrevOffCpu);
+                    hasPrevOffCpu = true;
+                }
+                if (exitedUidsEnabled_) {
+                    ReportExited_(exitedUids_, "uid", prevExitedUids, hasPrevExited, [](uint32_t uid) -> std::string {
+                        return CU::Format(CU_FMT("{}"), uid);
+                    });
+                }
+                if (exitedCommsEnabled_) {
+                    ReportExited_(exitedComms_, "comm", prevExitedComms, hasPrevExited, [](const cu_util_comm_key &key) -> std::string {
+                        return std::string(key.comm, strnlen(key.comm, sizeof(key.comm)));
+                    });
+                }
+                hasPrevExited = true;
+                nextTime += std::chrono::milliseconds(intervalMs_);
+                std::this_thread::sleep_until(nextTime);
+            }
+        }
+
+        int intervalMs_;
+        BusyTotalReader busyTotals_;
+        IdleStateReader idleStates_;
+        IrqStatsReader irqStats_;
+        CgroupStatsReader cgroupStats_;
+        ClassBusyReader classBusy_;
+        SliceHistReader sliceHist_;
+        SwitchCountReader switchCounts_;
+        TaskStatsReader taskStats_;
+        MigrationStatsReader migrationStats_;
+        int clusterIds_[CU_UTIL_MAX_CPUS];
+        WakeupCountReader wakeupCounts_;
+        WakeupPairReader wakeupPairs_;
+        TaskOffCpuReader taskOffCpu_;
+        ExitedUidReader exitedUids_;
+        ExitedCommReader exitedComms_;
+        bool busyTotalsEnabled_;
+        bool idleStatesEnabled_;
+        bool irqStatsEnabled_;
+        bool cgroupStatsEnabled_;
+        bool classBusyEnabled_;
+        bool sliceHistEnabled_;
+        bool switchCountsEnabled_;
+        bool taskStatsEnabled_;
+        bool migrationStatsEnabled_;
+        bool wakeupCountsEnabled_;
+        bool wakeupPairsEnabled_;
+        bool taskOffCpuEnabled_;
+        bool exitedUidsEnabled_;
+        bool exitedCommsEnabled_;
+};
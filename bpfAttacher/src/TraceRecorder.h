@@ -0,0 +1,282 @@
+#pragma once
+
+#include "utils/cu_libbpf.h"
+#include "utils/CuLogger.h"
+#include "utils/cu_sched_trace.h"
+#include <thread>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+
+// Drains the sched_switch event map of cu_sched_trace.c (a BPF ring buffer or a perf event array)
+// and appends the events to a binary trace file, see cu_sched_trace.h for the layout.
+class TraceRecorder
+{
+    public:
+        TraceRecorder() :
+            mapFd_(-1), dropMapFd_(-1), epollFd_(-1), outputFd_(-1), pageSize_(0), possibleCpuCount_(0),
+            ringConsumerPos_(nullptr), ringProducerPos_(nullptr), ringData_(nullptr), ringMask_(0),
+            perfBuffers_(), recordBuffer_(), writeBuffer_(), writeLen_(0), eventCount_(0), lostCount_(0) { }
+        TraceRecorder(const TraceRecorder &other) = delete;
+        TraceRecorder &operator=(const TraceRecorder &other) = delete;
+
+        bool start(const std::string &programName, const std::string &outputPath)
+        {
+            static constexpr char bpf_path[] = "/sys/fs/bpf";
+
+            mapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("{}/map_{}_sched_switch_event_map"), bpf_path, programName));
+            dropMapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("{}/map_{}_sched_switch_event_drop_map"), bpf_path, programName));
+            bpf_map_info mapInfo{};
+            if (mapFd_ < 0 || !CU::Bpf::GetMapInfo(mapFd_, std::addressof(mapInfo))) {
+                return false;
+            }
+            pageSize_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            possibleCpuCount_ = CU::Bpf::GetPossibleCpuCount();
+            epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+            if (epollFd_ < 0) {
+                return false;
+            }
+            if (mapInfo.type == BPF_MAP_TYPE_RINGBUF) {
+                if (!openRingBuffer_(mapInfo.max_entries)) {
+                    return false;
+                }
+            } else if (mapInfo.type == BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+                if (!openPerfBuffers_(mapInfo.max_entries)) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+
+            outputFd_ = open(outputPath.c_str(), (O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC), 0644);
+            if (outputFd_ < 0) {
+                return false;
+            }
+            writeBuffer_.resize(WRITE_BUFFER_SIZE);
+            cu_sched_trace_header header{};
+            header.magic = CU_SCHED_TRACE_MAGIC;
+            header.version = CU_SCHED_TRACE_VERSION;
+            header.record_size = sizeof(cu_sched_switch_event);
+            header.cpu_count = static_cast<uint32_t>(sysconf(_SC_NPROCESSORS_CONF));
+            header.clock_id = CLOCK_MONOTONIC;
+            append_(std::addressof(header), sizeof(header));
+
+            std::thread mainLoop(std::bind(&TraceRecorder::mainLoop_, this));
+            mainLoop.detach();
+            return true;
+        }
+
+    private:
+        static constexpr size_t WRITE_BUFFER_SIZE = 256 * 1024;
+        static constexpr size_t PERF_BUFFER_PAGES = 64;
+        static constexpr int FLUSH_INTERVAL_MS = 1000;
+        static constexpr int STATS_INTERVAL_MS = 60000;
+        static constexpr uint32_t RING_BUFFER_TOKEN = UINT32_MAX;
+
+        struct PerfBuffer
+        {
+            int fd;
+            uint8_t* base;
+        };
+
+        bool watchFd_(int fd, uint32_t token)
+        {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = token;
+            return (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, std::addressof(event)) == 0);
+        }
+
+        // The consumer page is writable, the producer page and the data area (mapped twice in a row,
+        // so records never wrap) are read-only.
+        bool openRingBuffer_(uint32_t ringSize)
+        {
+            auto consumer = mmap(nullptr, pageSize_, (PROT_READ | PROT_WRITE), MAP_SHARED, mapFd_, 0);
+            if (consumer == MAP_FAILED) {
+                return false;
+            }
+            auto producer = mmap(nullptr, pageSize_ + 2 * static_cast<size_t>(ringSize), PROT_READ, MAP_SHARED, mapFd_, pageSize_);
+            if (producer == MAP_FAILED) {
+                munmap(consumer, pageSize_);
+                return false;
+            }
+            ringConsumerPos_ = static_cast<unsigned long*>(consumer);
+            ringProducerPos_ = static_cast<const unsigned long*>(producer);
+            ringData_ = static_cast<const uint8_t*>(producer) + pageSize_;
+            ringMask_ = ringSize - 1;
+            return watchFd_(mapFd_, RING_BUFFER_TOKEN);
+        }
+
+        bool openPerfBuffers_(uint32_t maxEntries)
+        {
+            perf_event_attr perfEventAttr{};
+            perfEventAttr.size = sizeof(perfEventAttr);
+            perfEventAttr.type = PERF_TYPE_SOFTWARE;
+            perfEventAttr.config = PERF_COUNT_SW_BPF_OUTPUT;
+            perfEventAttr.sample_type = PERF_SAMPLE_RAW;
+            perfEventAttr.sample_period = 1;
+            perfEventAttr.wakeup_events = 64;
+
+            auto cpuCount = std::min(possibleCpuCount_, maxEntries);
+            for (uint32_t cpu = 0; cpu < cpuCount; cpu++) {
+                // Offline cpus can not open events, they do not produce any either.
+                int perfFd = static_cast<int>(syscall(__NR_perf_event_open, std::addressof(perfEventAttr), -1, cpu, -1, PERF_FLAG_FD_CLOEXEC));
+                if (perfFd < 0) {
+                    continue;
+                }
+                auto base = mmap(nullptr, pageSize_ * (PERF_BUFFER_PAGES + 1), (PROT_READ | PROT_WRITE), MAP_SHARED, perfFd, 0);
+                if (base == MAP_FAILED || CU::Bpf::SetElementValue(mapFd_, cpu, perfFd, BPF_ANY) < 0 ||
+                    ioctl(perfFd, PERF_EVENT_IOC_ENABLE, 0) < 0 || !watchFd_(perfFd, static_cast<uint32_t>(perfBuffers_.size()))
+                ) {
+                    if (base != MAP_FAILED) {
+                        munmap(base, pageSize_ * (PERF_BUFFER_PAGES + 1));
+                    }
+                    close(perfFd);
+                    continue;
+                }
+                perfBuffers_.emplace_back(PerfBuffer{perfFd, static_cast<uint8_t*>(base)});
+            }
+            return (perfBuffers_.size() > 0);
+        }
+
+        void drainRingBuffer_()
+        {
+            auto consumerPos = __atomic_load_n(ringConsumerPos_, __ATOMIC_ACQUIRE);
+            auto producerPos = __atomic_load_n(ringProducerPos_, __ATOMIC_ACQUIRE);
+            while (consumerPos < producerPos) {
+                auto header = reinterpret_cast<const uint32_t*>(ringData_ + (consumerPos & ringMask_));
+                auto len = __atomic_load_n(header, __ATOMIC_ACQUIRE);
+                if ((len & BPF_RINGBUF_BUSY_BIT) != 0) {
+                    break;
+                }
+                auto dataLen = len & ~(BPF_RINGBUF_BUSY_BIT | BPF_RINGBUF_DISCARD_BIT);
+                if ((len & BPF_RINGBUF_DISCARD_BIT) == 0) {
+                    appendEvent_(reinterpret_cast<const uint8_t*>(header) + BPF_RINGBUF_HDR_SZ, dataLen);
+                }
+                consumerPos += (dataLen + BPF_RINGBUF_HDR_SZ + 7) / 8 * 8;
+                __atomic_store_n(ringConsumerPos_, consumerPos, __ATOMIC_RELEASE);
+                if (consumerPos >= producerPos) {
+                    producerPos = __atomic_load_n(ringProducerPos_, __ATOMIC_ACQUIRE);
+                }
+            }
+        }
+
+        void drainPerfBuffer_(const PerfBuffer &perfBuffer)
+        {
+            auto metaPage = reinterpret_cast<perf_event_mmap_page*>(perfBuffer.base);
+            auto data = perfBuffer.base + pageSize_;
+            uint64_t dataSize = pageSize_ * PERF_BUFFER_PAGES;
+            uint64_t dataHead = __atomic_load_n(&metaPage->data_head, __ATOMIC_ACQUIRE);
+            uint64_t dataTail = metaPage->data_tail;
+            while (dataTail < dataHead) {
+                // Records are 8-byte aligned, so the header itself never wraps, the record may.
+                auto offset = dataTail % dataSize;
+                auto header = reinterpret_cast<const perf_event_header*>(data + offset);
+                const uint8_t* record = data + offset;
+                if (offset + header->size > dataSize) {
+                    recordBuffer_.resize(header->size);
+                    std::memcpy(recordBuffer_.data(), record, dataSize - offset);
+                    std::memcpy(recordBuffer_.data() + (dataSize - offset), data, header->size - (dataSize - offset));
+                    record = recordBuffer_.data();
+                }
+                if (header->type == PERF_RECORD_SAMPLE) {
+                    uint32_t rawSize = 0;
+                    std::memcpy(std::addressof(rawSize), record + sizeof(perf_event_header), sizeof(uint32_t));
+                    appendEvent_(record + sizeof(perf_event_header) + sizeof(uint32_t), rawSize);
+                } else if (header->type == PERF_RECORD_LOST) {
+                    uint64_t lost = 0;
+                    std::memcpy(std::addressof(lost), record + sizeof(perf_event_header) + sizeof(uint64_t), sizeof(uint64_t));
+                    lostCount_ += lost;
+                }
+                dataTail += header->size;
+            }
+            __atomic_store_n(&metaPage->data_tail, dataTail, __ATOMIC_RELEASE);
+        }
+
+        // Perf raw samples are padded, only the fixed-size event is kept.
+        void appendEvent_(const void* data, uint32_t len)
+        {
+            if (len < sizeof(cu_sched_switch_event)) {
+                return;
+            }
+            append_(data, sizeof(cu_sched_switch_event));
+            eventCount_++;
+        }
+
+        void append_(const void* data, size_t len)
+        {
+            if (writeLen_ + len > writeBuffer_.size()) {
+                flush_();
+            }
+            std::memcpy(writeBuffer_.data() + writeLen_, data, len);
+            writeLen_ += len;
+        }
+
+        void flush_()
+        {
+            size_t writtenLen = 0;
+            while (writtenLen < writeLen_) {
+                auto len = write(outputFd_, writeBuffer_.data() + writtenLen, writeLen_ - writtenLen);
+                if (len < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (len <= 0) {
+                    CU::Logger::Warn(CU_FMT("Failed to write the sched trace, {} bytes dropped."), writeLen_ - writtenLen);
+                    break;
+                }
+                writtenLen += static_cast<size_t>(len);
+            }
+            writeLen_ = 0;
+        }
+
+        uint64_t getDropCount_()
+        {
+            return (dropMapFd_ >= 0) ? CU::Bpf::GetPerCpuElementSum(dropMapFd_, 0) : 0;
+        }
+
+        void mainLoop_()
+        {
+            static constexpr int MAX_EVENTS = CU_SCHED_TRACE_MAX_CPUS;
+
+            epoll_event events[MAX_EVENTS]{};
+            auto nextStatsTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(STATS_INTERVAL_MS);
+            for (;;) {
+                int eventCount = epoll_wait(epollFd_, events, MAX_EVENTS, FLUSH_INTERVAL_MS);
+                for (int idx = 0; idx < eventCount; idx++) {
+                    auto token = events[idx].data.u32;
+                    if (token == RING_BUFFER_TOKEN) {
+                        drainRingBuffer_();
+                    } else if (token < perfBuffers_.size()) {
+                        drainPerfBuffer_(perfBuffers_[token]);
+                    }
+                }
+                // Keep the file reasonably fresh while the system is quiet.
+                if (eventCount == 0) {
+                    flush_();
+                }
+                auto now = std::chrono::steady_clock::now();
+                if (now >= nextStatsTime) {
+                    CU::Logger::Info(CU_FMT("Sched trace: {} events written, {} lost, {} dropped."), eventCount_, lostCount_, getDropCount_());
+                    nextStatsTime = now + std::chrono::milliseconds(STATS_INTERVAL_MS);
+                }
+            }
+        }
+
+        int mapFd_;
+        int dropMapFd_;
+        int epollFd_;
+        int outputFd_;
+        size_t pageSize_;
+        uint32_t possibleCpuCount_;
+        unsigned long* ringConsumerPos_;
+        const unsigned long* ringProducerPos_;
+        const uint8_t* ringData_;
+        unsigned long ringMask_;
+        std::vector<PerfBuffer> perfBuffers_;
+        std::vector<uint8_t> recordBuffer_;
+        std::vector<uint8_t> writeBuffer_;
+        size_t writeLen_;
+        uint64_t eventCount_;
+        uint64_t lostCount_;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "utils/cu_libbpf.h"
+#include "utils/CuLogger.h"
+#include "ShmPublisher.h"
+#include "HistoryWriter.h"
+#include <mutex>
+#include <thread>
+#include <time.h>
+
+class UtilSampler
+{
+    public:
+        UtilSampler() : busyMapFd_(-1), idleMapFd_(-1), cpuCount_(0), periodMs_(0), mtx_(), snapshot_(), publisher_(), history_(), historyEnabled_(false) { }
+        UtilSampler(const UtilSampler &other) = delete;
+        UtilSampler &operator=(const UtilSampler &other) = delete;
+
+        // Every sample is also appended to historyPath unless it is empty.
+        bool start(const std::string &programName, int periodMs, const std::string &historyPath = {})
+        {
+            static constexpr char bpf_path[] = "/sys/fs/bpf";
+
+            busyMapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("{}/map_{}_cpu_util_busy_total_ns_map"), bpf_path, programName));
+            idleMapFd_ = CU::Bpf::OpenObject(CU::Format(CU_FMT("{}/map_{}_cpu_util_idle_total_ns_map"), bpf_path, programName));
+            if (busyMapFd_ < 0 || idleMapFd_ < 0) {
+                return false;
+            }
+            cpuCount_ = std::min(static_cast<uint32_t>(sysconf(_SC_NPROCESSORS_CONF)),
+                static_cast<uint32_t>(CU_UTIL_QUERY_MAX_CPUS));
+            periodMs_ = std::max(periodMs, 1);
+            if (!publisher_.create("cu_util_shm")) {
+                CU::Logger::Warn(CU_FMT("Failed to create the utilization shared memory."));
+            }
+            if (historyPath.size() > 0) {
+                historyEnabled_ = history_.open(historyPath, cpuCount_, HISTORY_FLUSH_INTERVAL_MS);
+                if (!historyEnabled_) {
+                    CU::Logger::Warn(CU_FMT("Failed to open the utilization history \"{}\"."), historyPath);
+                }
+            }
+
+            std::thread mainLoop(std::bind(&UtilSampler::mainLoop_, this));
+            mainLoop.detach();
+            return true;
+        }
+
+        // Copies the latest sample into reply, returns the reply length or 0 if no sample was taken yet.
+        size_t snapshot(cu_util_query_reply* reply)
+        {
+            std::unique_lock<std::mutex> lck(mtx_);
+            if (snapshot_.header.sequence == 0) {
+                return 0;
+            }
+            std::memcpy(reply, std::addressof(snapshot_), sizeof(cu_util_query_reply));
+            return (sizeof(cu_util_query_reply_header) + sizeof(cu_util_cpu_sample) * snapshot_.header.cpu_count);
+        }
+
+        int shmFd() const noexcept
+        {
+            return publisher_.fd();
+        }
+
+    private:
+        static constexpr int HISTORY_FLUSH_INTERVAL_MS = 10000;
+
+        static uint64_t MonotonicNs_()
+        {
+            timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, std::addressof(ts));
+            return (static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec));
+        }
+
+        void mainLoop_()
+        {
+            uint64_t busyTotal[CU_UTIL_QUERY_MAX_CPUS]{};
+            uint64_t idleTotal[CU_UTIL_QUERY_MAX_CPUS]{};
+            cu_util_query_reply sample{};
+            sample.header.magic = CU_UTIL_QUERY_MAGIC;
+            sample.header.version = CU_UTIL_QUERY_VERSION;
+            sample.header.status = CU_UTIL_QUERY_STATUS_OK;
+            sample.header.cpu_count = cpuCount_;
+
+            bool readFailed = false;
+            auto nextTime = std::chrono::steady_clock::now();
+            for (;;) {
+                auto busyCount = CU::Bpf::GetArrayValues(busyMapFd_, busyTotal, cpuCount_);
+                auto idleCount = CU::Bpf::GetArrayValues(idleMapFd_, idleTotal, cpuCount_);
+                if (busyCount == cpuCount_ && idleCount == cpuCount_) {
+                    auto timestamp = MonotonicNs_();
+                    bool hasPrevSample = (sample.header.sequence > 0);
+                    sample.header.interval_ns = hasPrevSample ? (timestamp - sample.header.timestamp_ns) : 0;
+                    sample.header.timestamp_ns = timestamp;
+                    sample.header.sequence++;
+                    for (uint32_t cpu = 0; cpu < cpuCount_; cpu++) {
+                        auto &cpuSample = sample.cpus[cpu];
+                        cpuSample.busy_delta_ns = hasPrevSample ? (busyTotal[cpu] - cpuSample.busy_total_ns) : 0;
+                        cpuSample.idle_delta_ns = hasPrevSample ? (idleTotal[cpu] - cpuSample.idle_total_ns) : 0;
+                        cpuSample.busy_total_ns = busyTotal[cpu];
+                        cpuSample.idle_total_ns = idleTotal[cpu];
+                    }
+                    {
+                        std::unique_lock<std::mutex> lck(mtx_);
+                        std::memcpy(std::addressof(snapshot_), std::addressof(sample), sizeof(cu_util_query_reply));
+                    }
+                    publisher_.publish(std::addressof(sample));
+                    if (historyEnabled_) {
+                        history_.append(sample);
+                    }
+                    readFailed = false;
+                } else if (!readFailed) {
+                    CU::Logger::Warn(CU_FMT("Failed to read utilization maps."));
+                    readFailed = true;
+                }
+                nextTime += std::chrono::milliseconds(periodMs_);
+                std::this_thread::sleep_until(nextTime);
+            }
+        }
+
+        int busyMapFd_;
+        int idleMapFd_;
+        uint32_t cpuCount_;
+        int periodMs_;
+        std::mutex mtx_;
+        cu_util_query_reply snapshot_;
+        ShmPublisher publisher_;
+        HistoryWriter history_;
+        bool historyEnabled_;
+};
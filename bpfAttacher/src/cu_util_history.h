@@ -0,0 +1,200 @@
+#ifndef __CU_UTIL_HISTORY__
+#define __CU_UTIL_HISTORY__ 1
+
+// On-disk utilization history written by bpfDaemon --history.
+// A file is a cu_util_history_header followed by records, each record is a varint payload length and a payload of
+// a record kind byte, the timestamp and one (busy, idle) pair per cpu, all as LEB128 varints.
+// Key records carry absolute values, delta records carry the difference to the previous record. The writer starts
+// every session (and every counter reset) with a key record, so files can be appended to and truncated records
+// at the end of a file (crash while writing) are simply ignored by the reader.
+
+#include "cu_util_query.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CU_UTIL_HISTORY_MAGIC 0x48555543U // "CUUH"
+#define CU_UTIL_HISTORY_VERSION 1
+#define CU_UTIL_HISTORY_VARINT_MAX_LEN 10
+#define CU_UTIL_HISTORY_RECORD_MAX_LEN \
+    (CU_UTIL_HISTORY_VARINT_MAX_LEN + 1 + CU_UTIL_HISTORY_VARINT_MAX_LEN * (1 + 2 * CU_UTIL_QUERY_MAX_CPUS))
+
+enum cu_util_history_record_kind {
+    CU_UTIL_HISTORY_RECORD_KEY = 0,
+    CU_UTIL_HISTORY_RECORD_DELTA = 1
+};
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t cpu_count;
+    uint32_t clock_id;
+} cu_util_history_header;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    uint32_t cpu_count;
+    cu_util_query_reply sample;
+} cu_util_history_reader;
+
+// Returns the encoded length, buf needs CU_UTIL_HISTORY_VARINT_MAX_LEN bytes.
+static inline size_t cu_util_history_put_varint(uint8_t* buf, uint64_t value)
+{
+    size_t len = 0;
+    while (value >= 0x80) {
+        buf[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (uint8_t)value;
+    return len;
+}
+
+// Returns the decoded length, 0 if the varint is truncated or malformed.
+static inline size_t cu_util_history_get_varint(const uint8_t* buf, size_t size, uint64_t* value)
+{
+    uint64_t result = 0;
+    for (size_t idx = 0; idx < size && idx < CU_UTIL_HISTORY_VARINT_MAX_LEN; idx++) {
+        result |= (uint64_t)(buf[idx] & 0x7f) << (7 * idx);
+        if ((buf[idx] & 0x80) == 0) {
+            *value = result;
+            return idx + 1;
+        }
+    }
+    return 0;
+}
+
+// Encodes sample as a record, prev is the previously encoded sample or NULL for a key record.
+// Returns the record length, buf needs CU_UTIL_HISTORY_RECORD_MAX_LEN bytes.
+static inline size_t cu_util_history_encode(uint8_t* buf, const cu_util_query_reply* sample, const cu_util_query_reply* prev)
+{
+    uint8_t payload[CU_UTIL_HISTORY_RECORD_MAX_LEN];
+    uint32_t cpu_count = sample->header.cpu_count;
+    if (prev != NULL) {
+        if (sample->header.timestamp_ns < prev->header.timestamp_ns) {
+            prev = NULL;
+        }
+        for (uint32_t cpu = 0; prev != NULL && cpu < cpu_count; cpu++) {
+            if (sample->cpus[cpu].busy_total_ns < prev->cpus[cpu].busy_total_ns ||
+                sample->cpus[cpu].idle_total_ns < prev->cpus[cpu].idle_total_ns
+            ) {
+                prev = NULL;
+            }
+        }
+    }
+
+    size_t len = 0;
+    payload[len++] = (prev != NULL) ? CU_UTIL_HISTORY_RECORD_DELTA : CU_UTIL_HISTORY_RECORD_KEY;
+    len += cu_util_history_put_varint(payload + len,
+        sample->header.timestamp_ns - ((prev != NULL) ? prev->header.timestamp_ns : 0));
+    for (uint32_t cpu = 0; cpu < cpu_count; cpu++) {
+        len += cu_util_history_put_varint(payload + len,
+            sample->cpus[cpu].busy_total_ns - ((prev != NULL) ? prev->cpus[cpu].busy_total_ns : 0));
+        len += cu_util_history_put_varint(payload + len,
+            sample->cpus[cpu].idle_total_ns - ((prev != NULL) ? prev->cpus[cpu].idle_total_ns : 0));
+    }
+
+    size_t header_len = cu_util_history_put_varint(buf, len);
+    memcpy(buf + header_len, payload, len);
+    return header_len + len;
+}
+
+// Maps the history file, returns 0 on failure.
+static inline int cu_util_history_open(cu_util_history_reader* reader, const char* path)
+{
+    memset(reader, 0, sizeof(cu_util_history_reader));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(cu_util_history_header)) {
+        close(fd);
+        return 0;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    cu_util_history_header header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != CU_UTIL_HISTORY_MAGIC || header.version != CU_UTIL_HISTORY_VERSION ||
+        header.header_size < sizeof(header) || header.header_size > (size_t)st.st_size ||
+        header.cpu_count == 0 || header.cpu_count > CU_UTIL_QUERY_MAX_CPUS
+    ) {
+        munmap(data, (size_t)st.st_size);
+        return 0;
+    }
+    reader->data = (const uint8_t*)data;
+    reader->size = (size_t)st.st_size;
+    reader->pos = header.header_size;
+    reader->cpu_count = header.cpu_count;
+    reader->sample.header.magic = CU_UTIL_QUERY_MAGIC;
+    reader->sample.header.version = CU_UTIL_QUERY_VERSION;
+    reader->sample.header.status = CU_UTIL_QUERY_STATUS_OK;
+    reader->sample.header.cpu_count = header.cpu_count;
+    return 1;
+}
+
+// Decodes the next record, returns NULL at the end of the file or at a truncated record.
+// The returned sample stays valid until the next call.
+static inline const cu_util_query_reply* cu_util_history_next(cu_util_history_reader* reader)
+{
+    uint64_t payload_len = 0;
+    size_t len = cu_util_history_get_varint(reader->data + reader->pos, reader->size - reader->pos, &payload_len);
+    if (len == 0 || payload_len < 2 || payload_len > reader->size - reader->pos - len) {
+        return NULL;
+    }
+    const uint8_t* payload = reader->data + reader->pos + len;
+    size_t payload_pos = 1;
+    uint8_t kind = payload[0];
+    if (kind != CU_UTIL_HISTORY_RECORD_KEY && kind != CU_UTIL_HISTORY_RECORD_DELTA) {
+        return NULL;
+    }
+
+    cu_util_query_reply* sample = &reader->sample;
+    uint64_t values[1 + 2 * CU_UTIL_QUERY_MAX_CPUS];
+    uint32_t value_count = 1 + 2 * reader->cpu_count;
+    for (uint32_t idx = 0; idx < value_count; idx++) {
+        size_t value_len = cu_util_history_get_varint(payload + payload_pos, payload_len - payload_pos, &values[idx]);
+        if (value_len == 0) {
+            return NULL;
+        }
+        payload_pos += value_len;
+    }
+
+    int is_delta = (kind == CU_UTIL_HISTORY_RECORD_DELTA && sample->header.sequence > 0);
+    uint64_t timestamp = is_delta ? (sample->header.timestamp_ns + values[0]) : values[0];
+    sample->header.interval_ns = (sample->header.sequence > 0 && timestamp >= sample->header.timestamp_ns) ?
+        (timestamp - sample->header.timestamp_ns) : 0;
+    sample->header.timestamp_ns = timestamp;
+    sample->header.sequence++;
+    for (uint32_t cpu = 0; cpu < reader->cpu_count; cpu++) {
+        cu_util_cpu_sample* cpu_sample = &sample->cpus[cpu];
+        uint64_t busy_total = is_delta ? (cpu_sample->busy_total_ns + values[1 + 2 * cpu]) : values[1 + 2 * cpu];
+        uint64_t idle_total = is_delta ? (cpu_sample->idle_total_ns + values[2 + 2 * cpu]) : values[2 + 2 * cpu];
+        cpu_sample->busy_delta_ns = is_delta ? values[1 + 2 * cpu] : 0;
+        cpu_sample->idle_delta_ns = is_delta ? values[2 + 2 * cpu] : 0;
+        cpu_sample->busy_total_ns = busy_total;
+        cpu_sample->idle_total_ns = idle_total;
+    }
+    reader->pos += len + (size_t)payload_len;
+    return sample;
+}
+
+static inline void cu_util_history_close(cu_util_history_reader* reader)
+{
+    if (reader->data != NULL) {
+        munmap((void*)reader->data, reader->size);
+    }
+    memset(reader, 0, sizeof(cu_util_history_reader));
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef __CU_UTIL_QUERY__
+#define __CU_UTIL_QUERY__ 1
+
+// Binary protocol of the bpfDaemon query socket (AF_UNIX, SOCK_SEQPACKET).
+// A client sends one cu_util_query_request per packet and receives one reply packet made of
+// a cu_util_query_reply_header followed by cpu_count cu_util_cpu_sample entries.
+// CU_UTIL_QUERY_CMD_SHM_FD replies with a bare header carrying the shared-memory fd as SCM_RIGHTS, see cu_util_shm.h.
+
+#include <stdint.h>
+
+#define CU_UTIL_QUERY_MAGIC 0x51555543U // "CUUQ"
+#define CU_UTIL_QUERY_VERSION 1
+#define CU_UTIL_QUERY_MAX_CPUS 16
+
+enum cu_util_query_command {
+    CU_UTIL_QUERY_CMD_SNAPSHOT = 1,
+    CU_UTIL_QUERY_CMD_SHM_FD = 2
+};
+
+enum cu_util_query_status {
+    CU_UTIL_QUERY_STATUS_OK = 0,
+    CU_UTIL_QUERY_STATUS_BAD_REQUEST = 1,
+    CU_UTIL_QUERY_STATUS_NOT_READY = 2
+};
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t command;
+} cu_util_query_request;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t status;
+    uint32_t cpu_count;
+    uint32_t reserved;
+    uint64_t sequence;
+    uint64_t timestamp_ns;
+    uint64_t interval_ns;
+} cu_util_query_reply_header;
+
+typedef struct {
+    uint64_t busy_total_ns;
+    uint64_t idle_total_ns;
+    uint64_t busy_delta_ns;
+    uint64_t idle_delta_ns;
+} cu_util_cpu_sample;
+
+typedef struct {
+    cu_util_query_reply_header header;
+    cu_util_cpu_sample cpus[CU_UTIL_QUERY_MAX_CPUS];
+} cu_util_query_reply;
+
+#endif
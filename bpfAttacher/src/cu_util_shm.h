@@ -0,0 +1,99 @@
+#ifndef __CU_UTIL_SHM__
+#define __CU_UTIL_SHM__ 1
+
+// Shared-memory publication of the bpfDaemon utilization samples.
+// The daemon hands out a sealed, read-only memfd on CU_UTIL_QUERY_CMD_SHM_FD requests, the region is
+// guarded by a seqlock: sequence is odd while the daemon is writing and advances by 2 per sample.
+
+#include "cu_util_query.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define CU_UTIL_SHM_SIZE 4096
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t reserved;
+    cu_util_query_reply reply;
+} cu_util_shm_region;
+
+static inline void cu_util_shm_write(cu_util_shm_region* shm, const cu_util_query_reply* reply)
+{
+    uint32_t sequence = __atomic_load_n(&shm->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&shm->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&shm->reply, reply, sizeof(cu_util_query_reply));
+    __atomic_store_n(&shm->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+// Copies a consistent snapshot out of the region, returns 0 if no sample was published yet.
+static inline int cu_util_shm_read(const cu_util_shm_region* shm, cu_util_query_reply* reply)
+{
+    for (;;) {
+        uint32_t sequence = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+        if ((sequence & 1) != 0) {
+            continue;
+        }
+        memcpy(reply, &shm->reply, sizeof(cu_util_query_reply));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == sequence) {
+            return (sequence != 0);
+        }
+    }
+}
+
+// Fetches the memfd from the query socket and maps it, returns NULL on failure.
+static inline const cu_util_shm_region* cu_util_shm_open(const char* socket_path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        return NULL;
+    }
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, socket_path);
+
+    int sock_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock_fd < 0) {
+        return NULL;
+    }
+    cu_util_query_request request = {CU_UTIL_QUERY_MAGIC, CU_UTIL_QUERY_VERSION, CU_UTIL_QUERY_CMD_SHM_FD};
+    if (connect(sock_fd, (const struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        send(sock_fd, &request, sizeof(request), MSG_NOSIGNAL) != sizeof(request)
+    ) {
+        close(sock_fd);
+        return NULL;
+    }
+
+    cu_util_query_reply_header header;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = {&header, sizeof(header)};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t len = recvmsg(sock_fd, &msg, MSG_CMSG_CLOEXEC);
+    close(sock_fd);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (len != sizeof(header) || header.status != CU_UTIL_QUERY_STATUS_OK || cmsg == NULL ||
+        cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS
+    ) {
+        return NULL;
+    }
+    int shm_fd = -1;
+    memcpy(&shm_fd, CMSG_DATA(cmsg), sizeof(int));
+    void* shm = mmap(NULL, CU_UTIL_SHM_SIZE, PROT_READ, MAP_SHARED, shm_fd, 0);
+    close(shm_fd);
+    if (shm == MAP_FAILED) {
+        return NULL;
+    }
+    return (const cu_util_shm_region*)shm;
+}
+
+#endif
@@ -3,9 +3,33 @@
 #include "utils/cu_libbpf.h"
 #include "utils/CuSched.h"
 #include "utils/CuLogger.h"
+#include "utils/cu_util_monitor.h"
+#include "AttachManager.h"
+#include "QueryServer.h"
+#include "TraceRecorder.h"
+#include "StatsReporter.h"
 
 constexpr char DAEMON_NAME[] = "bpfDaemon";
 
+struct DaemonConfig
+{
+    std::string programName;
+    std::vector<std::pair<AttachManager::AttachType, std::string>> attachTargets;
+    std::string monitoredCpus;
+    bool sampledAccounting;
+    bool cgroupAccounting;
+    bool taskStats;
+    bool wakeupPairs;
+    bool offCpuStats;
+    int sampleFreq;
+    std::string socketPath;
+    std::string traceOutputPath;
+    std::string historyPath;
+    int samplePeriodMs;
+    int statsIntervalMs;
+    int checkIntervalMs;
+};
+
 std::vector<std::string> ParseArgs(int argc, char* argv[])
 {
     std::vector<std::string> args{};
@@ -17,73 +41,229 @@ std::vector<std::string> ParseArgs(int argc, char* argv[])
         argv_size += arg.size() + 1;
     }
     memset(argv[0], 0, argv_size);
-    strncpy(argv[0], DAEMON_NAME, sizeof(DAEMON_NAME));
+    strncpy(argv[0], DAEMON_NAME, argv_size - 1);
     return args;
 }
 
-void DaemonMain(const std::string &programName, const std::vector<std::string> &tracePoints)
+// A cpu mask that is malformed, empty, past the utilization maps or absent from the device would stop all accounting.
+bool IsValidCpuMask(const std::string &cpus)
+{
+    auto requestedCpus = CU::SchedAffinity::FromString(cpus).cpuList();
+    if (requestedCpus.size() == 0 || requestedCpus.back() >= CU_UTIL_MAX_CPUS) {
+        return false;
+    }
+    auto possibleCpus = CU::SchedAffinity::FromCpuList(CU::ReadFile("/sys/devices/system/cpu/possible"));
+    return std::any_of(requestedCpus.begin(), requestedCpus.end(), [&possibleCpus](int cpu) { return possibleCpus.hasCpu(cpu); });
+}
+
+void DaemonMain(const DaemonConfig &config)
 {
-    static const auto attachToTracePoint = [](const std::string &progName, const std::string &tracePoint) -> int {
+    // Program sections are named "<type>/<target>", the loader pins them with '/' replaced by '_'.
+    static const auto getProgPath = 
+        [](const std::string &progName, AttachManager::AttachType type, const std::string &target) -> std::string
+    {
         static constexpr char bpf_path[] = "/sys/fs/bpf";
 
-        auto tracePointCategory = CU::SubPrevStr(tracePoint, '/');
-        auto tracePointName = CU::SubPostStr(tracePoint, '/');
-        auto progObject = CU::Format("prog_{}_tracepoint_{}_{}", progName, tracePointCategory, tracePointName);
-        auto bpfObjects = CU::ListFile(bpf_path, DT_REG);
-        for (const auto &bpfObject : bpfObjects) {
-            if (bpfObject == progObject) {
-                int progFd = CU::Bpf::OpenObject(CU::Format("{}/{}", bpf_path, bpfObject));
-                if (progFd >= 0) {
-                    return CU::Bpf::ProgAttachTracePoint(progFd, tracePoint);
-                }
-            }
+        // Only the target can contain '/', program and type names never do.
+        auto progTarget = (target.size() > 0 && target[0] == '/') ? (target.c_str() + 1) : target.c_str();
+        char progPath[PATH_MAX];
+        auto pathLen = CU::FormatTo(progPath, sizeof(progPath), CU_FMT("{}/prog_{}_{}_{}"),
+            bpf_path, progName, AttachManager::AttachTypeName(type), progTarget);
+        if (pathLen >= sizeof(progPath)) {
+            return {};
+        }
+        std::replace((progPath + sizeof(bpf_path)), (progPath + pathLen), '/', '_');
+        if (access(progPath, F_OK) < 0) {
+            return {};
+        }
+        return progPath;
+    };
+
+    // The config map is pinned and outlives the daemon, it is always rewritten so no option of a previous run
+    // stays in effect. Programs without it (e.g. CuSchedTrace) have nothing to configure.
+    static const auto setUtilConfig = [](const std::string &progName, const cu_util_config &utilConfig) -> int {
+        int configFd = CU::Bpf::OpenObject(CU::Format(CU_FMT("/sys/fs/bpf/map_{}_cpu_util_config_map"), progName));
+        if (configFd < 0) {
+            return 0;
         }
-        return -1;
+        int ret = CU::Bpf::SetElementValue(configFd, 0, utilConfig, BPF_ANY);
+        close(configFd);
+        return (ret >= 0) ? 1 : -1;
     };
 
     CU::SetThreadName(DAEMON_NAME);
     CU::SetTaskSchedPrio(0, 120);
 
-    for (const auto &tracePoint : tracePoints) {
-        if (attachToTracePoint(programName, tracePoint) >= 0) {
-            CU::Logger::Info("The attachment of program \"{}\" to tracepoint \"{}\" succeeded.", programName, tracePoint);
+    auto monitoredCpus = CU::SchedAffinity::FromCpuList(CU::ReadFile("/sys/devices/system/cpu/possible"));
+    if (config.monitoredCpus.size() > 0) {
+        std::vector<int> cpuList{};
+        for (int cpu : CU::SchedAffinity::FromString(config.monitoredCpus).cpuList()) {
+            if (monitoredCpus.hasCpu(cpu)) {
+                cpuList.emplace_back(cpu);
+            } else {
+                CU::Logger::Warn(CU_FMT("CPU {} is not present on this device and will not be monitored."), cpu);
+            }
+        }
+        monitoredCpus = CU::SchedAffinity(cpuList);
+    }
+    uint64_t samplePeriodNs = 1000000000 / std::max(config.sampleFreq, 1);
+    cu_util_config utilConfig{};
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (!monitoredCpus.hasCpu(cpu)) {
+            utilConfig.ignored_cpu_mask |= (1ULL << cpu);
+        }
+    }
+    if (config.sampledAccounting) {
+        utilConfig.flags |= CU_UTIL_FLAG_SAMPLED_ACCOUNTING;
+        utilConfig.sample_period_ns = samplePeriodNs;
+    }
+    if (config.cgroupAccounting) {
+        utilConfig.flags |= CU_UTIL_FLAG_CGROUP_ACCOUNTING;
+    }
+    if (config.taskStats) {
+        utilConfig.flags |= CU_UTIL_FLAG_TASK_STATS;
+    }
+    if (config.wakeupPairs) {
+        utilConfig.flags |= CU_UTIL_FLAG_WAKEUP_PAIRS;
+    }
+    if (config.offCpuStats) {
+        utilConfig.flags |= CU_UTIL_FLAG_OFFCPU_STATS;
+    }
+    int configRet = setUtilConfig(config.programName, utilConfig);
+    if (configRet > 0) {
+        CU::Logger::Info(CU_FMT("Accounting: {}{}{}{}{}, cpus \"{}\"."), (config.sampledAccounting ? "sampled" : "exact"),
+            (config.cgroupAccounting ? " with cgroups" : ""), (config.taskStats ? " with tasks" : ""),
+            (config.wakeupPairs ? " with wakeup pairs" : ""), (config.offCpuStats ? " with off-cpu time" : ""),
+            (config.monitoredCpus.size() > 0 ? config.monitoredCpus : "all"));
+    } else if (configRet < 0) {
+        CU::Logger::Warn(CU_FMT("Failed to write the utilization config of program \"{}\"."), config.programName);
+    } else {
+        CU::Logger::Info(CU_FMT("Program \"{}\" has no utilization config."), config.programName);
+    }
+
+    static AttachManager attachManager{};
+    for (const auto &[type, target] : config.attachTargets) {
+        auto progPath = getProgPath(config.programName, type, target);
+        if (progPath.size() > 0 && attachManager.attach(type, progPath, target)) {
+            CU::Logger::Info(CU_FMT("The attachment of program \"{}\" to {} \"{}\" succeeded."),
+                config.programName, AttachManager::AttachTypeName(type), target);
+        } else {
+            CU::Logger::Warn(CU_FMT("The attachment of program \"{}\" to {} \"{}\" failed."),
+                config.programName, AttachManager::AttachTypeName(type), target);
+        }
+    }
+
+    if (config.sampledAccounting) {
+        auto progPath = getProgPath(config.programName, AttachManager::AttachType::PERF_EVENT, "cpu_clock");
+        if (progPath.size() > 0 && attachManager.attachCpuClock(progPath, samplePeriodNs, monitoredCpus)) {
+            CU::Logger::Info(CU_FMT("The attachment of program \"{}\" to cpu clock ({}Hz) succeeded."), config.programName, config.sampleFreq);
+        } else {
+            CU::Logger::Warn(CU_FMT("The attachment of program \"{}\" to cpu clock ({}Hz) failed."), config.programName, config.sampleFreq);
+        }
+    }
+
+    attachManager.start(config.checkIntervalMs);
+
+    static UtilSampler sampler{};
+    static QueryServer queryServer(sampler);
+    if (config.socketPath.size() > 0 || config.historyPath.size() > 0) {
+        if (!sampler.start(config.programName, config.samplePeriodMs, config.historyPath)) {
+            CU::Logger::Warn(CU_FMT("Failed to open the utilization maps of program \"{}\"."), config.programName);
+        } else if (config.socketPath.size() > 0 && !queryServer.start(config.socketPath)) {
+            CU::Logger::Warn(CU_FMT("Failed to listen on query socket \"{}\"."), config.socketPath);
+        } else {
+            CU::Logger::Info(CU_FMT("Utilization sampler ready (sample period {}ms)."), config.samplePeriodMs);
+        }
+    }
+
+    static TraceRecorder traceRecorder{};
+    if (config.traceOutputPath.size() > 0) {
+        if (traceRecorder.start(config.programName, config.traceOutputPath)) {
+            CU::Logger::Info(CU_FMT("Recording sched trace of program \"{}\" to \"{}\"."), config.programName, config.traceOutputPath);
+        } else {
+            CU::Logger::Warn(CU_FMT("Failed to record sched trace of program \"{}\" to \"{}\"."), config.programName, config.traceOutputPath);
+        }
+    }
+
+    static StatsReporter statsReporter{};
+    if (config.statsIntervalMs > 0) {
+        if (statsReporter.start(config.programName, config.statsIntervalMs)) {
+            CU::Logger::Info(CU_FMT("Reporting monitor statistics every {}ms."), config.statsIntervalMs);
         } else {
-            CU::Logger::Warn("The attachment of program \"{}\" to tracepoint \"{}\" failed.", programName, tracePoint);
+            CU::Logger::Warn(CU_FMT("Program \"{}\" has no statistics maps."), config.programName);
         }
     }
 
-    CU::Logger::Info("Daemon Running (pid={}).", getpid());
+    CU::Logger::Info(CU_FMT("Daemon Running (pid={})."), getpid());
     CU::Pause();
 }
 
 int main(int argc, char* argv[])
 {
     std::string logPath = "/data/bpf_daemon.log";
-    std::string programName{};
-    std::vector<std::string> tracePoints{};
+    DaemonConfig config{};
+    config.samplePeriodMs = 100;
+    config.statsIntervalMs = 0;
+    config.checkIntervalMs = 5000;
+    config.sampledAccounting = false;
+    config.cgroupAccounting = false;
+    config.taskStats = false;
+    config.wakeupPairs = false;
+    config.offCpuStats = false;
+    config.sampleFreq = 250;
 
     auto args = ParseArgs(argc, argv);
     for (size_t idx = 1; idx < args.size(); idx++) {
         if (args[idx] == "--log" && (idx + 1) < args.size()) {
             logPath = args[++idx];
         } else if (args[idx] == "--program" && (idx + 1) < args.size()) {
-            programName = args[++idx];
+            config.programName = args[++idx];
         } else if (args[idx] == "--add-tracepoint" && (idx + 1) < args.size()) {
-            tracePoints.emplace_back(args[++idx]);
+            config.attachTargets.emplace_back(AttachManager::AttachType::TRACEPOINT, args[++idx]);
+        } else if (args[idx] == "--add-kprobe" && (idx + 1) < args.size()) {
+            config.attachTargets.emplace_back(AttachManager::AttachType::KPROBE, args[++idx]);
+        } else if (args[idx] == "--add-uprobe" && (idx + 1) < args.size()) {
+            config.attachTargets.emplace_back(AttachManager::AttachType::UPROBE, args[++idx]);
+        } else if (args[idx] == "--cpus" && (idx + 1) < args.size() && IsValidCpuMask(args[idx + 1])) {
+            config.monitoredCpus = args[++idx];
+        } else if (args[idx] == "--accounting" && (idx + 1) < args.size() && (args[idx + 1] == "exact" || args[idx + 1] == "sampled")) {
+            config.sampledAccounting = (args[++idx] == "sampled");
+        } else if (args[idx] == "--cgroup-accounting") {
+            config.cgroupAccounting = true;
+        } else if (args[idx] == "--task-stats") {
+            config.taskStats = true;
+        } else if (args[idx] == "--wakeup-pairs") {
+            config.wakeupPairs = true;
+        } else if (args[idx] == "--offcpu-stats") {
+            config.offCpuStats = true;
+        } else if (args[idx] == "--sample-freq" && (idx + 1) < args.size()) {
+            config.sampleFreq = CU::StrToInt(args[++idx]);
+        } else if (args[idx] == "--socket" && (idx + 1) < args.size()) {
+            config.socketPath = args[++idx];
+        } else if (args[idx] == "--history" && (idx + 1) < args.size()) {
+            config.historyPath = args[++idx];
+        } else if (args[idx] == "--trace-output" && (idx + 1) < args.size()) {
+            config.traceOutputPath = args[++idx];
+        } else if (args[idx] == "--sample-period" && (idx + 1) < args.size()) {
+            config.samplePeriodMs = CU::StrToInt(args[++idx]);
+        } else if (args[idx] == "--stats-interval" && (idx + 1) < args.size()) {
+            config.statsIntervalMs = CU::StrToInt(args[++idx]);
+        } else if (args[idx] == "--check-interval" && (idx + 1) < args.size()) {
+            config.checkIntervalMs = CU::StrToInt(args[++idx]);
         } else {
             CU::Println("Invalid Arguments.");
             return -1;
         }
     }
-    if (programName.size() == 0 || tracePoints.size() == 0) {
+    if (config.programName.size() == 0 || (config.attachTargets.size() == 0 && !config.sampledAccounting)) {
         return 0;
     }
 
     CU::Println("Daemon Start.");
     daemon(0, 0);
     CU::Logger::Create(CU::Logger::LogLevel::VERBOSE, logPath);
-    CU::Logger::Info("BPF Daemon by chenzyadb@github.com");
-    DaemonMain(programName, tracePoints);
+    CU::Logger::Info(CU_FMT("BPF Daemon by chenzyadb@github.com"));
+    DaemonMain(config);
 
     return 0;
 }
@@ -1,5 +1,5 @@
 // CuFormat by chenzyadb@github.com
-// Based on C++11 STL (GNUC)
+// Based on C++17 STL (GNUC)
 
 #if !defined(_CU_FORMAT_)
 #define _CU_FORMAT_ 1
@@ -11,10 +11,24 @@
 #include <exception>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <type_traits>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cstdarg>
+#include <climits>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <charconv>
+
+// Shortest round trip floating point to_chars: libstdc++ 11+, libc++ 14+.
+#if defined(__cpp_lib_to_chars) || (defined(_LIBCPP_VERSION) && _LIBCPP_VERSION >= 14000)
+#define _CU_FORMAT_FLOAT_TO_CHARS_ 1
+#endif
 
 namespace CU 
 {
@@ -83,6 +97,9 @@ namespace CU
             auto new_len = length + other.length;
             if (new_len >= capacity) {
                 resize(capacity + new_len);
+                if (new_len >= capacity) {
+                    return;
+                }
             }
             std::memcpy((data() + length), other.data(), other.length);
             *(data() + new_len) = '\0';
@@ -95,6 +112,9 @@ namespace CU
             auto new_len = length + src_len;
             if (new_len >= capacity) {
                 resize(capacity + new_len);
+                if (new_len >= capacity) {
+                    return;
+                }
             }
             std::memcpy((data() + length), src, src_len);
             *(data() + new_len) = '\0';
@@ -105,6 +125,9 @@ namespace CU
         {
             if ((length + 1) >= capacity) {
                 resize(capacity * 2);
+                if ((length + 1) >= capacity) {
+                    return;
+                }
             }
             *(data() + length) = ch;
             *(data() + length + 1) = '\0';
@@ -128,9 +151,10 @@ namespace CU
                 }
             } else {
                 capacity = sizeof(stack_buffer);
-                if (heap_block != nullptr && length > 0) {
+                if (heap_block != nullptr) {
                     std::memcpy(stack_buffer, heap_block, length);
                     std::free(heap_block);
+                    heap_block = nullptr;
                 }
                 stack_buffer[length] = '\0';
             }
@@ -196,66 +220,183 @@ namespace CU
         return value;
     }
 
+    // Large enough for any integer, shortest float (long double included) and padded hex value.
+    constexpr size_t _Max_Number_Chars = 64;
+
+    constexpr char _Digit_Pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    struct HexValue
+    {
+        uint64_t value;
+        int width;
+    };
+
+    // Formats an integer as lowercase hex without prefix, zero padded to width digits.
     template <typename _Ty>
-    inline _Format_String _Decimal_To_String(_Ty value) noexcept
-    {
-        char buffer[16] = ".";
-        auto dec = (value - static_cast<size_t>(value)) * 10;
-        for (size_t pos = 1; pos < (sizeof(buffer) - 1); pos++) {
-            buffer[pos] = '0' + static_cast<char>(static_cast<size_t>(dec) % 10);
-            dec = (dec - static_cast<size_t>(dec)) * 10;
-            if (dec == 0) {
-                break;
+    inline HexValue Hex(_Ty value, int width = 0) noexcept
+    {
+        static_assert(std::is_integral<_Ty>::value, "Hex needs an integer value");
+        return HexValue{static_cast<uint64_t>(static_cast<std::make_unsigned_t<_Ty>>(value)), width};
+    }
+
+    // Writes two digits per division backwards from end, returns the first digit.
+    inline char* _Write_Digits_Backward(char* end, uint64_t value) noexcept
+    {
+        while (value >= 100) {
+            auto pair_pos = static_cast<size_t>(value % 100) * 2;
+            value /= 100;
+            end -= 2;
+            end[0] = _Digit_Pairs[pair_pos];
+            end[1] = _Digit_Pairs[pair_pos + 1];
+        }
+        if (value >= 10) {
+            auto pair_pos = static_cast<size_t>(value) * 2;
+            end -= 2;
+            end[0] = _Digit_Pairs[pair_pos];
+            end[1] = _Digit_Pairs[pair_pos + 1];
+        } else {
+            end--;
+            *end = static_cast<char>('0' + value);
+        }
+        return end;
+    }
+
+    inline size_t _Count_Digits(uint64_t value) noexcept
+    {
+        size_t digits = 1;
+        while (true) {
+            if (value < 10) {
+                return digits;
             }
+            if (value < 100) {
+                return digits + 1;
+            }
+            if (value < 1000) {
+                return digits + 2;
+            }
+            if (value < 10000) {
+                return digits + 3;
+            }
+            value /= 10000;
+            digits += 4;
         }
-        return buffer;
     }
 
     template <typename _Ty>
-    inline _Format_String _Int_To_String(_Ty value) noexcept
-    {
-        char buffer[32] = { 0 };
-        auto pos = sizeof(buffer) - 2;
-        if (value > 0) {
-            for (auto integer = value; integer > 0; integer /= 10) {
-                buffer[pos] = '0' + static_cast<char>(integer % 10);
-                pos--;
+    inline size_t _Int_To_Chars(char* buffer, _Ty value) noexcept
+    {
+        auto abs_value = static_cast<uint64_t>(value);
+        size_t len = 0;
+        if constexpr (std::is_signed<_Ty>::value) {
+            if (value < 0) {
+                // Unsigned negation, -value overflows for the minimum.
+                abs_value = 0 - static_cast<uint64_t>(value);
+                buffer[len++] = '-';
             }
-            pos++;
-        } else if (value < 0) {
-            for (auto integer = -value; integer > 0; integer /= 10) {
-                buffer[pos] = '0' + static_cast<char>(integer % 10);
-                pos--;
+        }
+        len += _Count_Digits(abs_value);
+        _Write_Digits_Backward((buffer + len), abs_value);
+        return len;
+    }
+
+    inline size_t _Hex_To_Chars(char* buffer, uint64_t value, int width) noexcept
+    {
+        static constexpr char hex_digits[] = "0123456789abcdef";
+#if defined(__GNUC__)
+        auto len = static_cast<size_t>(67 - __builtin_clzll(value | 1)) / 4;
+#else
+        size_t len = 1;
+        for (auto remaining = value >> 4; remaining > 0; remaining >>= 4) {
+            len++;
+        }
+#endif
+        auto padded_len = static_cast<size_t>((width > 32) ? 32 : ((width > 0) ? width : 0));
+        if (padded_len < len) {
+            padded_len = len;
+        }
+        std::memset(buffer, '0', padded_len - len);
+        for (auto pos = padded_len; pos > padded_len - len; pos--) {
+            buffer[pos - 1] = hex_digits[value & 0xf];
+            value >>= 4;
+        }
+        return padded_len;
+    }
+
+    // Shortest representation that reads back to the same value, integral values keep a ".0".
+    template <typename _Ty>
+    inline size_t _Float_To_Chars(char* buffer, _Ty value) noexcept
+    {
+#if defined(_CU_FORMAT_FLOAT_TO_CHARS_)
+        auto len = static_cast<size_t>(std::to_chars(buffer, (buffer + _Max_Number_Chars - 3), value).ptr - buffer);
+#else
+        // No floating point to_chars in this STL, probe the precision instead.
+        size_t len = 0;
+        for (int precision = std::numeric_limits<_Ty>::digits10; precision <= std::numeric_limits<_Ty>::max_digits10; precision++) {
+            len = static_cast<size_t>(std::snprintf(buffer, (_Max_Number_Chars - 3), "%.*Lg", precision, static_cast<long double>(value)));
+            _Ty parsed_value = 0;
+            if constexpr (std::is_same<_Ty, float>::value) {
+                parsed_value = std::strtof(buffer, nullptr);
+            } else if constexpr (std::is_same<_Ty, double>::value) {
+                parsed_value = std::strtod(buffer, nullptr);
+            } else {
+                parsed_value = std::strtold(buffer, nullptr);
+            }
+            if (parsed_value == value) {
+                break;
             }
-            buffer[pos] = '-';
-        } else {
-            buffer[pos] = '0';
         }
-        return &buffer[pos];
+#endif
+        if (std::isfinite(value) && std::memchr(buffer, '.', len) == nullptr && std::memchr(buffer, 'e', len) == nullptr) {
+            buffer[len++] = '.';
+            buffer[len++] = '0';
+        }
+        return len;
     }
 
     template <typename _Ty>
-    inline _Format_String _Float_To_String(_Ty value) noexcept
+    inline std::enable_if_t<std::is_integral<_Ty>::value && !std::is_same<_Ty, bool>::value && !std::is_same<_Ty, char>::value, size_t>
+    _To_Chars(char* buffer, _Ty value) noexcept
     {
-        if (value < 0) {
-            _Format_String str("-");
-            str.append(_Int_To_String(static_cast<size_t>(-value)));
-            str.append(_Decimal_To_String(-value));
-            return str;
-        } else if (value > 0) {
-            _Format_String str(_Int_To_String(static_cast<size_t>(value)));
-            str.append(_Decimal_To_String(value));
-            return str;
-        }
-        return "0";
+        return _Int_To_Chars(buffer, value);
+    }
+
+    template <typename _Ty>
+    inline std::enable_if_t<std::is_floating_point<_Ty>::value, size_t> _To_Chars(char* buffer, _Ty value) noexcept
+    {
+        return _Float_To_Chars(buffer, value);
+    }
+
+    inline size_t _To_Chars(char* buffer, const HexValue &value) noexcept
+    {
+        return _Hex_To_Chars(buffer, value.value, value.width);
+    }
+
+    template <typename _Ty, typename = void>
+    struct _Has_To_Chars : std::false_type { };
+
+    template <typename _Ty>
+    struct _Has_To_Chars<_Ty, decltype(static_cast<void>(_To_Chars(std::declval<char*>(), std::declval<const _Ty &>())))> :
+        std::true_type { };
+
+    template <typename _Ty>
+    inline _Format_String _Number_To_Format_String(const _Ty &value) noexcept
+    {
+        char buffer[_Max_Number_Chars];
+        buffer[_To_Chars(buffer, value)] = '\0';
+        return buffer;
     }
 
     template <typename _Ptr_Ty>
     inline _Format_String _To_Format_String(const _Ptr_Ty* value) noexcept
     {
-        auto addr_val = reinterpret_cast<size_t>(value);
+        auto addr_val = reinterpret_cast<uintptr_t>(value);
         if (addr_val > 0) {
-            return _Int_To_String(addr_val);
+            char buffer[_Max_Number_Chars] = "0x";
+            buffer[2 + _Hex_To_Chars(buffer + 2, addr_val, 0)] = '\0';
+            return buffer;
         }
         return "NULL";
     }
@@ -265,69 +406,74 @@ namespace CU
         return "NULL";
     }
 
+    inline _Format_String _To_Format_String(const HexValue &value) noexcept
+    {
+        return _Number_To_Format_String(value);
+    }
+
     inline _Format_String _To_Format_String(long double value) noexcept
     {
-        return _Float_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(double value) noexcept
     {
-        return _Float_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(float value) noexcept
     {
-        return _Float_To_String(value); 
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(unsigned long long value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(unsigned long value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(unsigned int value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(unsigned short value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(unsigned char value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(long long value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(long value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(int value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(short value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(signed char value) noexcept
     {
-        return _Int_To_String(value);
+        return _Number_To_Format_String(value);
     }
 
     inline _Format_String _To_Format_String(bool value) noexcept
@@ -425,7 +571,10 @@ namespace CU
                             format_items.back().arg_idx = format_items.size() - 1;
                             format_items.back().max_length = _String_To_Int(format + pos + 1);
                             format_items.emplace_back();
-                            pos = _Find_Char(format, '}', (pos + 1)) + 1;
+                            pos = _Find_Char(format, '}', (pos + 1));
+                            if (pos != _npos) {
+                                pos++;
+                            }
                         }
                         break;
                     case '0':
@@ -440,13 +589,13 @@ namespace CU
                     case '9':
                         {
                             format_items.back().arg_idx = _String_To_Int(format + pos);
-                            auto next_pos = _Find_Char(format, '}', (pos + 1)) + 1;
+                            auto next_pos = _Find_Char(format, '}', (pos + 1));
                             auto size_ch_pos = _Find_Char(format, ':', (pos + 1));
                             if (size_ch_pos != _npos && size_ch_pos < next_pos) {
                                 format_items.back().max_length = _String_To_Int(format + size_ch_pos + 1);
                             }
                             format_items.emplace_back();
-                            pos = next_pos;
+                            pos = (next_pos != _npos) ? (next_pos + 1) : _npos;
                         }
                         break;
                     default:
@@ -479,7 +628,7 @@ namespace CU
         for (auto iter = format_items.begin(); iter < format_items.end(); ++iter) {
             content.append(iter->content);
             if (iter->arg_idx != -1) {
-                if (iter->arg_idx >= args_list.size()) {
+                if (static_cast<size_t>(iter->arg_idx) >= args_list.size()) {
                     throw FormatExcept("Argument index out of bound");
                 }
                 if (iter->max_length < INT_MAX) {
@@ -498,6 +647,249 @@ namespace CU
         return format;
     }
 
+    // Format rules known at compile time, CU_FMT("...") wraps a string literal into a type so the rule is parsed once
+    // by the compiler, Format then appends the literal segments and the arguments in a single pass.
+    // Invalid rules and out of bound argument indexes are compile errors.
+    struct _Compiled_Format { };
+
+    #define CU_FMT(format_str) \
+        [] { \
+            struct _Format_Str : CU::_Compiled_Format \
+            { \
+                static constexpr const char* data() noexcept { return format_str; } \
+                static constexpr size_t size() noexcept { return sizeof(format_str) - 1; } \
+            }; \
+            return _Format_Str{}; \
+        }()
+
+    template <typename _Fmt>
+    constexpr bool _Is_Compiled_Format = std::is_base_of<_Compiled_Format, _Fmt>::value;
+
+    struct _Format_Segment
+    {
+        size_t literal_pos;
+        size_t literal_len;
+        int arg_idx;
+        int max_length;
+    };
+
+    template <size_t _Max_Segments>
+    struct _Format_Spec
+    {
+        _Format_Segment segments[_Max_Segments];
+        size_t count;
+        size_t literal_size;
+        int max_arg_idx;
+    };
+
+    constexpr int _Parse_Format_Int(const char* str, size_t &pos)
+    {
+        if (str[pos] < '0' || str[pos] > '9') {
+            throw FormatExcept("Invaild format rule");
+        }
+        int value = 0;
+        while (str[pos] >= '0' && str[pos] <= '9') {
+            value = value * 10 + (str[pos] - '0');
+            pos++;
+        }
+        return value;
+    }
+
+    // Same rules as _Format_Impl: "{}", "{n}", "{:len}", "{n:len}", "{{" and "}}".
+    template <typename _Fmt>
+    constexpr _Format_Spec<_Fmt::size() + 1> _Parse_Format()
+    {
+        _Format_Spec<_Fmt::size() + 1> spec{};
+        const char* format = _Fmt::data();
+        size_t size = _Fmt::size();
+        const auto nextSegment = [&spec](size_t literal_pos) {
+            spec.segments[spec.count] = _Format_Segment{literal_pos, 0, -1, INT_MAX};
+            spec.count++;
+        };
+
+        int slot_count = 0;
+        spec.max_arg_idx = -1;
+        nextSegment(0);
+        size_t pos = 0;
+        while (pos < size) {
+            auto &segment = spec.segments[spec.count - 1];
+            if ((format[pos] == '{' && format[pos + 1] == '{') || (format[pos] == '}' && format[pos + 1] == '}')) {
+                segment.literal_len++;
+                spec.literal_size++;
+                pos += 2;
+                nextSegment(pos);
+            } else if (format[pos] == '{' && (pos + 1) < size) {
+                size_t rule_pos = pos + 1;
+                segment.arg_idx = slot_count;
+                if (format[rule_pos] != ':' && format[rule_pos] != '}') {
+                    segment.arg_idx = _Parse_Format_Int(format, rule_pos);
+                }
+                if (format[rule_pos] == ':') {
+                    rule_pos++;
+                    segment.max_length = _Parse_Format_Int(format, rule_pos);
+                }
+                if (format[rule_pos] != '}') {
+                    throw FormatExcept("Invaild format rule");
+                }
+                spec.max_arg_idx = (segment.arg_idx > spec.max_arg_idx) ? segment.arg_idx : spec.max_arg_idx;
+                slot_count++;
+                pos = rule_pos + 1;
+                nextSegment(pos);
+            } else if (format[pos] == '}') {
+                throw FormatExcept("Invaild format rule");
+            } else {
+                segment.literal_len++;
+                spec.literal_size++;
+                pos++;
+            }
+        }
+        return spec;
+    }
+
+    template <typename _Fmt>
+    struct _Compiled_Format_Spec
+    {
+        static constexpr auto value = _Parse_Format<_Fmt>();
+    };
+
+    // Truncates like snprintf, at most capacity - 1 chars are written and the buffer is always terminated.
+    struct _Format_Buffer_Sink
+    {
+        char* buffer;
+        size_t capacity;
+        size_t length;
+
+        void append(const char* src, size_t len) noexcept
+        {
+            // The common unbounded copy keeps gcc from expanding memcpy into a slow rep movs.
+            if ((length + len) < capacity) {
+                std::memcpy((buffer + length), src, len);
+            } else if ((length + 1) < capacity) {
+                std::memcpy((buffer + length), src, (capacity - 1 - length));
+            }
+            length += len;
+        }
+    };
+
+    template <typename _Out, typename _Ty>
+    inline void _Append_Arg(_Out &out, const _Ty &value, int max_length)
+    {
+        const auto appendStr = [&out, max_length](const char* src, size_t len) {
+            out.append(src, (len < static_cast<size_t>(max_length)) ? len : static_cast<size_t>(max_length));
+        };
+        if constexpr (std::is_same<_Ty, std::string>::value) {
+            appendStr(value.data(), value.size());
+        } else if constexpr (std::is_convertible<const _Ty &, const char*>::value && !std::is_same<_Ty, std::nullptr_t>::value) {
+            const char* str = value;
+            if (str != nullptr) {
+                appendStr(str, std::strlen(str));
+            } else {
+                appendStr("NULL", 4);
+            }
+        } else if constexpr (_Has_To_Chars<_Ty>::value) {
+            if constexpr (std::is_same<_Out, _Format_Buffer_Sink>::value) {
+                // Convert in place when the whole number fits, integers take at most 20 digits and a sign,
+                // hex values at most 32 padded digits.
+                constexpr size_t max_chars = std::is_integral<_Ty>::value ? 24 :
+                    (std::is_same<_Ty, HexValue>::value ? 33 : _Max_Number_Chars);
+                if (max_length == INT_MAX && (out.length + max_chars) < out.capacity) {
+                    out.length += _To_Chars((out.buffer + out.length), value);
+                    return;
+                }
+            }
+            char buffer[_Max_Number_Chars];
+            appendStr(buffer, _To_Chars(buffer, value));
+        } else {
+            auto str = _To_Format_String(value);
+            appendStr(str.data(), str.length);
+        }
+    }
+
+    template <typename _Fmt, size_t _Idx, typename _Out, typename _Args_Tuple>
+    inline void _Append_Segment(_Out &out, const _Args_Tuple &args)
+    {
+        constexpr auto segment = _Compiled_Format_Spec<_Fmt>::value.segments[_Idx];
+        if constexpr (segment.literal_len > 0) {
+            out.append(_Fmt::data() + segment.literal_pos, segment.literal_len);
+        }
+        if constexpr (segment.arg_idx >= 0) {
+            _Append_Arg(out, std::get<segment.arg_idx>(args), segment.max_length);
+        }
+    }
+
+    template <typename _Fmt, typename _Out, typename _Args_Tuple, size_t... _Idx>
+    inline void _Format_Compiled(_Out &out, const _Args_Tuple &args, std::index_sequence<_Idx...>)
+    {
+        (_Append_Segment<_Fmt, _Idx>(out, args), ...);
+    }
+
+    template <typename _Fmt, typename _Out, typename... _Args>
+    inline void _Format_Compiled_To(_Out &out, const _Args &...args)
+    {
+        constexpr auto &spec = _Compiled_Format_Spec<_Fmt>::value;
+        static_assert(spec.max_arg_idx < static_cast<int>(sizeof...(_Args)), "Argument index out of bound");
+        _Format_Compiled<_Fmt>(out, std::forward_as_tuple(args...), std::make_index_sequence<spec.count>());
+    }
+
+    template <typename _Output_Iter>
+    struct _Format_Iterator_Sink
+    {
+        _Output_Iter iter;
+
+        void append(const char* src, size_t len)
+        {
+            iter = std::copy(src, (src + len), iter);
+        }
+    };
+
+    template <typename _Fmt, typename... _Args>
+    inline std::enable_if_t<_Is_Compiled_Format<_Fmt>, std::string> Format(_Fmt, const _Args &...args)
+    {
+        std::string content{};
+        content.reserve(_Compiled_Format_Spec<_Fmt>::value.literal_size + sizeof...(_Args) * 16);
+        _Format_Compiled_To<_Fmt>(content, args...);
+        return content;
+    }
+
+    // Formats into a caller provided buffer without touching the allocator.
+    // Returns the length of the complete result like snprintf, a result >= capacity means it was truncated.
+    template <typename _Fmt, typename... _Args>
+    inline std::enable_if_t<_Is_Compiled_Format<_Fmt>, size_t> FormatTo(char* buffer, size_t capacity, _Fmt, const _Args &...args)
+    {
+        _Format_Buffer_Sink sink{buffer, capacity, 0};
+        _Format_Compiled_To<_Fmt>(sink, args...);
+        if (capacity > 0) {
+            buffer[(sink.length < capacity) ? sink.length : (capacity - 1)] = '\0';
+        }
+        return sink.length;
+    }
+
+    // Formats through an output iterator, e.g. std::back_inserter, returns the iterator past the last char.
+    template <typename _Output_Iter, typename _Fmt, typename... _Args>
+    inline std::enable_if_t<_Is_Compiled_Format<_Fmt>, _Output_Iter> FormatTo(_Output_Iter iter, _Fmt, const _Args &...args)
+    {
+        _Format_Iterator_Sink<_Output_Iter> sink{iter};
+        _Format_Compiled_To<_Fmt>(sink, args...);
+        return sink.iter;
+    }
+
+    inline std::string &_Thread_Format_Buffer() noexcept
+    {
+        static thread_local std::string buffer{};
+        return buffer;
+    }
+
+    // Formats into a buffer owned by the calling thread, which keeps its capacity so repeated calls stop allocating.
+    // The result is only valid until the next FormatTemp call of the thread, never pass it to FormatTemp again.
+    template <typename _Fmt, typename... _Args>
+    inline std::enable_if_t<_Is_Compiled_Format<_Fmt>, const std::string &> FormatTemp(_Fmt, const _Args &...args)
+    {
+        auto &content = _Thread_Format_Buffer();
+        content.clear();
+        _Format_Compiled_To<_Fmt>(content, args...);
+        return content;
+    }
+
     template <typename... _Args>
     inline int Println(const char* format, const _Args &...args) 
     {
@@ -509,6 +901,12 @@ namespace CU
         return std::puts(format);
     }
 
+    template <typename _Fmt, typename... _Args>
+    inline std::enable_if_t<_Is_Compiled_Format<_Fmt>, int> Println(_Fmt format, const _Args &...args)
+    {
+        return std::puts(Format(format, args...).c_str());
+    }
+
     template <typename _Ty>
     inline std::string To_String(const _Ty &value)
     {
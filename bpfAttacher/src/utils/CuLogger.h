@@ -1,5 +1,5 @@
 // CuLogger by chenzyadb.
-// Based on C++11 STL (GNUC) & CuFormat
+// Based on C++17 STL (GNUC) & CuFormat
 
 #if !defined(_CU_LOGGER_)
 #define _CU_LOGGER_ 1
@@ -14,67 +14,140 @@
 #include <thread>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <ctime>
 #include "CuFormat.h"
 
 namespace CU
 {
+	// Producers format a line into a thread local buffer and copy it into a pending buffer under a short lock,
+	// the writer thread swaps the pending buffer out and does the file I/O without holding the lock.
+	// Pending lines are capped at maxPendingBytes, lines beyond it are dropped and counted.
 	class Logger
 	{
 		public:
 			enum class LogLevel : uint8_t {NONE, ERROR, WARN, INFO, DEBUG, VERBOSE};
 
-			static void Create(const LogLevel &level, const std::string &path)
+			static void Create(const LogLevel &level, const std::string &path, size_t maxPendingBytes = (1 << 20))
 			{
-				Instance_().setLogger_(level, path);
+				Instance_().setLogger_(level, path, maxPendingBytes);
 			}
 
-			template <typename ..._Args>
-			static void Error(const char* format, const _Args &...args)
+			template <typename _Fmt, typename ..._Args>
+			static void Error(const _Fmt &format, const _Args &...args)
 			{
-				Instance_().joinLogQueue_(LogLevel::ERROR, CU::Format(format, args...));
+				Log_(LogLevel::ERROR, format, args...);
 			}
 
-			template <typename ..._Args>
-			static void Warn(const char* format, const _Args &...args)
+			template <typename _Fmt, typename ..._Args>
+			static void Warn(const _Fmt &format, const _Args &...args)
 			{
-				Instance_().joinLogQueue_(LogLevel::WARN, CU::Format(format, args...));
+				Log_(LogLevel::WARN, format, args...);
 			}
 
-			template <typename ..._Args>
-			static void Info(const char* format, const _Args &...args)
+			template <typename _Fmt, typename ..._Args>
+			static void Info(const _Fmt &format, const _Args &...args)
 			{
-				Instance_().joinLogQueue_(LogLevel::INFO, CU::Format(format, args...));
+				Log_(LogLevel::INFO, format, args...);
 			}
 
-			template <typename ..._Args>
-			static void Debug(const char* format, const _Args &...args)
+			template <typename _Fmt, typename ..._Args>
+			static void Debug(const _Fmt &format, const _Args &...args)
 			{
-				Instance_().joinLogQueue_(LogLevel::DEBUG, CU::Format(format, args...));
+				Log_(LogLevel::DEBUG, format, args...);
 			}
 
-			template <typename ..._Args>
-			static void Verbose(const char* format, const _Args &...args)
+			template <typename _Fmt, typename ..._Args>
+			static void Verbose(const _Fmt &format, const _Args &...args)
 			{
-				Instance_().joinLogQueue_(LogLevel::VERBOSE, CU::Format(format, args...));
+				Log_(LogLevel::VERBOSE, format, args...);
 			}
 
+			// Waits until every line logged so far has been written.
 			static void Flush()
 			{
 				Instance_().flushLogQueue_();
 			}
 
+			static uint64_t DroppedLines()
+			{
+				return Instance_().droppedLines_.load(std::memory_order_relaxed);
+			}
+
 		private:
-			Logger() : logPath_(), logLevel_(), cv_(), mtx_(), logQueue_(), queueFlushed_(true) { }
+			Logger() : 
+				logPath_(), 
+				logLevel_(LogLevel::NONE), 
+				cv_(), 
+				flushedCv_(), 
+				mtx_(), 
+				pendingBuffer_(), 
+				maxPendingBytes_(0), 
+				pendingSeq_(0), 
+				writtenSeq_(0), 
+				writerRunning_(false), 
+				writerWaiting_(false), 
+				droppedLines_(0) 
+			{ }
+
 			Logger(Logger &other) = delete;
 			Logger &operator=(Logger &other) = delete;
 
+			// Never destroyed, the detached writer thread may still be waiting on it at exit.
 			static Logger &Instance_()
 			{
-				static Logger instance{};
-				return instance;
+				static auto instance = new Logger();
+				return *instance;
+			}
+
+			template <typename _Fmt, typename ..._Args>
+			static void Log_(LogLevel level, const _Fmt &format, const _Args &...args)
+			{
+				auto &instance = Instance_();
+				if (level > instance.logLevel_.load(std::memory_order_relaxed)) {
+					return;
+				}
+				auto &line = LineBuffer_();
+				line.clear();
+				AppendLinePrefix_(line, level);
+				if constexpr (CU::_Is_Compiled_Format<_Fmt>) {
+					CU::_Format_Compiled_To<_Fmt>(line, args...);
+				} else {
+					line += CU::Format(format, args...);
+				}
+				line += '\n';
+				instance.joinLogQueue_(line.data(), line.size());
+			}
+
+			// One buffer per thread, shared by every call site regardless of the format type.
+			static std::string &LineBuffer_()
+			{
+				static thread_local std::string line{};
+				return line;
 			}
 
-			void setLogger_(const LogLevel &level, const std::string &path)
+			// "MM-DD hh:mm:ss [L] ", localtime only runs once per second and thread.
+			static void AppendLinePrefix_(std::string &line, LogLevel level)
+			{
+				static constexpr char levelTags[][6] = {" [N] ", " [E] ", " [W] ", " [I] ", " [D] ", " [V] "};
+				static thread_local time_t cachedTime = 0;
+				static thread_local char cachedTimeInfo[32] = {0};
+				static thread_local size_t cachedTimeInfoLen = 0;
+
+				auto nowTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+				if (nowTime != cachedTime || cachedTimeInfoLen == 0) {
+					struct tm localTime{};
+					localtime_r(std::addressof(nowTime), std::addressof(localTime));
+					auto len = std::snprintf(cachedTimeInfo, sizeof(cachedTimeInfo), "%02d-%02d %02d:%02d:%02d",
+						localTime.tm_mon + 1, localTime.tm_mday, localTime.tm_hour, localTime.tm_min, localTime.tm_sec);
+					cachedTimeInfoLen = (len > 0) ? static_cast<size_t>(len) : 0;
+					cachedTime = nowTime;
+				}
+				line.append(cachedTimeInfo, cachedTimeInfoLen);
+				line.append(levelTags[static_cast<size_t>(level)], 5);
+			}
+
+			void setLogger_(const LogLevel &level, const std::string &path, size_t maxPendingBytes)
 			{
 				static const auto createFile = [](const std::string &filePath) -> bool {
 					auto fp = std::fopen(filePath.c_str(), "wt");
@@ -85,10 +158,14 @@ namespace CU
 					return false;
 				};
 
-				if (logLevel_ == LogLevel::NONE && level != LogLevel::NONE) {
-					logLevel_ = level;
+				std::unique_lock<std::mutex> lck(mtx_);
+				if (logLevel_.load(std::memory_order_relaxed) == LogLevel::NONE && level != LogLevel::NONE) {
 					logPath_ = path;
 					if (createFile(logPath_)) {
+						maxPendingBytes_ = std::max<size_t>(maxPendingBytes, 4096);
+						pendingBuffer_.reserve(maxPendingBytes_);
+						writerRunning_ = true;
+						logLevel_.store(level, std::memory_order_relaxed);
 						std::thread mainLoop(std::bind(&Logger::mainLoop_, this));
 						mainLoop.detach();
 					}
@@ -99,83 +176,86 @@ namespace CU
 			{
 				auto fp = std::fopen(logPath_.c_str(), "at");
 				if (fp == nullptr) {
+					std::unique_lock<std::mutex> lck(mtx_);
+					logLevel_.store(LogLevel::NONE, std::memory_order_relaxed);
+					writerRunning_ = false;
+					flushedCv_.notify_all();
 					return;
 				}
-				std::vector<std::string> writeQueue{};
+				// Swapping hands the reserved capacity back and forth, neither side allocates once running.
+				std::string writeBuffer{};
+				writeBuffer.reserve(maxPendingBytes_);
+				uint64_t reportedDrops = 0;
 				for (;;) {
+					uint64_t writeSeq = 0;
 					{
 						std::unique_lock<std::mutex> lck(mtx_);
-						queueFlushed_ = logQueue_.empty();
-						while (logQueue_.empty()) {
-							cv_.wait(lck);
-						}
-						writeQueue = logQueue_;
-						logQueue_.clear();
+						writerWaiting_ = true;
+						cv_.wait(lck, [this]() { return !pendingBuffer_.empty(); });
+						writerWaiting_ = false;
+						std::swap(pendingBuffer_, writeBuffer);
+						writeSeq = pendingSeq_;
+					}
+					auto droppedLines = droppedLines_.load(std::memory_order_relaxed);
+					if (droppedLines != reportedDrops) {
+						std::string line{};
+						AppendLinePrefix_(line, LogLevel::WARN);
+						line += CU::Format(CU_FMT("{} log lines dropped, the log queue was full.\n"), droppedLines - reportedDrops);
+						std::fputs(line.c_str(), fp);
+						reportedDrops = droppedLines;
 					}
-					if (!writeQueue.empty()) {
-						for (const auto &log : writeQueue) {
-							std::fputs(log.c_str(), fp);
-						}
-						std::fflush(fp);
-						writeQueue.clear();
+					std::fwrite(writeBuffer.data(), 1, writeBuffer.size(), fp);
+					std::fflush(fp);
+					writeBuffer.clear();
+					{
+						std::unique_lock<std::mutex> lck(mtx_);
+						writtenSeq_ = writeSeq;
 					}
+					flushedCv_.notify_all();
 				}
 			}
 
-			void joinLogQueue_(const LogLevel &level, const std::string &content)
+			void joinLogQueue_(const char* line, size_t len)
 			{
-				static const auto getTimeInfo = []() -> std::string {
-					auto now = std::chrono::system_clock::now();
-					auto nowTime = std::chrono::system_clock::to_time_t(now);
-					auto localTime = std::localtime(std::addressof(nowTime));
-					return CU::CFormat("%02d-%02d %02d:%02d:%02d",
-						localTime->tm_mon + 1, localTime->tm_mday, localTime->tm_hour, localTime->tm_min, localTime->tm_sec);
-				};
-
-				std::unique_lock<std::mutex> lck(mtx_);
-				if (level <= logLevel_) {
-					switch (level) {
-						case LogLevel::ERROR:
-							logQueue_.emplace_back(getTimeInfo() + " [E] " + content + '\n');
-							break;
-						case LogLevel::WARN:
-							logQueue_.emplace_back(getTimeInfo() + " [W] " + content + '\n');
-							break;
-						case LogLevel::INFO:
-							logQueue_.emplace_back(getTimeInfo() + " [I] " + content + '\n');
-							break;
-						case LogLevel::DEBUG:
-							logQueue_.emplace_back(getTimeInfo() + " [D] " + content + '\n');
-							break;
-						case LogLevel::VERBOSE:
-							logQueue_.emplace_back(getTimeInfo() + " [V] " + content + '\n');
-							break;
-						default:
-							break;
+				bool wakeWriter = false;
+				{
+					std::unique_lock<std::mutex> lck(mtx_);
+					if (!writerRunning_ || (pendingBuffer_.size() + len) > maxPendingBytes_) {
+						droppedLines_.fetch_add(1, std::memory_order_relaxed);
+						return;
 					}
-					cv_.notify_all();
+					// Only the first line after the writer went idle wakes it, the rest ride along.
+					wakeWriter = (writerWaiting_ && pendingBuffer_.empty());
+					pendingBuffer_.append(line, len);
+					pendingSeq_++;
+				}
+				if (wakeWriter) {
+					cv_.notify_one();
 				}
 			}
 
 			void flushLogQueue_()
 			{
-				bool flushed = false;
-				while (!flushed) {
-					{
-						std::unique_lock<std::mutex> lck(mtx_);
-						flushed = queueFlushed_;
-					}
-					std::this_thread::sleep_for(std::chrono::milliseconds(10));
-				}
+				std::unique_lock<std::mutex> lck(mtx_);
+				auto flushSeq = pendingSeq_;
+				flushedCv_.wait(lck, [this, flushSeq]() {
+					return (!writerRunning_ || writtenSeq_ >= flushSeq);
+				});
 			}
 
 			std::string logPath_;
-			LogLevel logLevel_;
+			std::atomic<LogLevel> logLevel_;
 			std::condition_variable cv_;
+			std::condition_variable flushedCv_;
 			std::mutex mtx_;
-			std::vector<std::string> logQueue_;
-			volatile bool queueFlushed_;
-		};
+			std::string pendingBuffer_;
+			size_t maxPendingBytes_;
+			uint64_t pendingSeq_;
+			uint64_t writtenSeq_;
+			bool writerRunning_;
+			bool writerWaiting_;
+			std::atomic<uint64_t> droppedLines_;
+	};
 }
 
 #endif // !defined(_CU_LOGGER_)
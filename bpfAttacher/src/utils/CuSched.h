@@ -9,10 +9,16 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <limits>
+#include <cstdlib>
 #include <sched.h>
 #include <sys/prctl.h>
 #include <sys/resource.h>
 
+#ifndef SCHED_NORMAL
+#define SCHED_NORMAL SCHED_OTHER
+#endif
+
 #define CU_INLINE __attribute__((always_inline)) inline
 #define CU_LIKELY(val) (__builtin_expect(!!(val), 1))
 #define CU_UNLIKELY(val) (__builtin_expect(!!(val), 0))
@@ -34,6 +40,73 @@ namespace CU
 				return SchedAffinity(std::addressof(cpuset));
 			}
 
+			// Parses the cpu list format used by sysfs and cpusets, e.g. "0-3,6".
+			// A malformed list yields an empty set rather than the cpus parsed so far.
+			static CU_INLINE SchedAffinity FromCpuList(const std::string &cpuList) noexcept
+			{
+				cpu_set_t cpuset{};
+				auto str = cpuList.c_str();
+				while (*str != '\0') {
+					char* end = nullptr;
+					long first = std::strtol(str, &end, 10);
+					if (end == str || first < 0) {
+						return SchedAffinity();
+					}
+					long last = first;
+					if (*end == '-') {
+						str = end + 1;
+						last = std::strtol(str, &end, 10);
+						if (end == str || last < first) {
+							return SchedAffinity();
+						}
+					}
+					if ((*end != '\0' && *end != ',' && *end != ' ' && *end != '\n') || last >= CPU_SETSIZE) {
+						return SchedAffinity();
+					}
+					for (long cpu = first; cpu <= last; cpu++) {
+						CPU_SET(cpu, std::addressof(cpuset));
+					}
+					str = end;
+					while (*str == ',' || *str == ' ' || *str == '\n') {
+						str++;
+					}
+				}
+				return SchedAffinity(std::addressof(cpuset));
+			}
+
+			// Accepts either a hex cpu mask ("0xf0") or a cpu list ("4-7"), anything malformed yields an empty set.
+			static CU_INLINE SchedAffinity FromString(const std::string &str) noexcept
+			{
+				if (str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+					cpu_set_t cpuset{};
+					int cpu = 0;
+					for (auto iter = str.rbegin(); iter < (str.rend() - 2); ++iter) {
+						int digit = 0;
+						if (*iter >= '0' && *iter <= '9') {
+							digit = *iter - '0';
+						} else if (*iter >= 'a' && *iter <= 'f') {
+							digit = *iter - 'a' + 10;
+						} else if (*iter >= 'A' && *iter <= 'F') {
+							digit = *iter - 'A' + 10;
+						} else {
+							return SchedAffinity();
+						}
+						for (int bit = 0; bit < 4; bit++) {
+							if ((digit & (1 << bit)) == 0) {
+								continue;
+							}
+							if ((cpu + bit) >= CPU_SETSIZE) {
+								return SchedAffinity();
+							}
+							CPU_SET(cpu + bit, std::addressof(cpuset));
+						}
+						cpu += 4;
+					}
+					return SchedAffinity(std::addressof(cpuset));
+				}
+				return FromCpuList(str);
+			}
+
 			CU_INLINE SchedAffinity() noexcept : cpuset_() { }
 
 			CU_INLINE SchedAffinity(const std::vector<int> &cpuList) noexcept : cpuset_()
@@ -80,6 +153,22 @@ namespace CU
 				sched_setaffinity(pid, sizeof(cpu_set_t), std::addressof(cpuset_));
 			}
 
+			CU_INLINE bool hasCpu(int cpu) const noexcept
+			{
+				return (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, std::addressof(cpuset_)));
+			}
+
+			CU_INLINE std::vector<int> cpuList() const
+			{
+				std::vector<int> cpus{};
+				for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+					if (CPU_ISSET(cpu, std::addressof(cpuset_))) {
+						cpus.emplace_back(cpu);
+					}
+				}
+				return cpus;
+			}
+
 			CU_INLINE const cpu_set_t* cpuset() const noexcept
 			{
 				return std::addressof(cpuset_);
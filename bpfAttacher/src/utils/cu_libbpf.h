@@ -4,9 +4,12 @@
 #include "CuFile.h"
 #include "CuFormat.h"
 #include "cu_bpf_def.h"
+#include <cerrno>
+#include <fcntl.h>
 #include <unistd.h>
 #include <linux/perf_event.h>
 #include <sys/syscall.h>
+#include <sys/ioctl.h>
 #include <sys/resource.h>
 
 namespace CU 
@@ -78,24 +81,199 @@ namespace CU
             return static_cast<int>(syscall(__NR_bpf, BPF_OBJ_GET, std::addressof(attr), sizeof(attr)));
         }
 
-        inline int ProgAttachTracePoint(int progFd, const std::string &tracePoint)
+        inline int ProgAttachPerfEvent(int progFd, const perf_event_attr &perfEventAttr, int cpu)
         {
+            int targetFd = syscall(__NR_perf_event_open, std::addressof(perfEventAttr), -1, cpu, -1, PERF_FLAG_FD_CLOEXEC);
+            if (targetFd < 0) {
+                return -1;
+            }
+            if (ioctl(targetFd, PERF_EVENT_IOC_SET_BPF, progFd) < 0 || ioctl(targetFd, PERF_EVENT_IOC_ENABLE, 0) < 0) {
+                close(targetFd);
+                return -1;
+            }
+            return targetFd;
+        }
+
+        // Reads a small decimal value such as a tracepoint id or a pmu type, returns -1 on failure.
+        inline long long ReadSysValue(const char* path) noexcept
+        {
+            char buffer[32]{};
+            int fd = open(path, (O_RDONLY | O_CLOEXEC));
+            if (fd < 0) {
+                return -1;
+            }
+            auto len = read(fd, buffer, (sizeof(buffer) - 1));
+            close(fd);
+            if (len <= 0 || buffer[0] < '0' || buffer[0] > '9') {
+                return -1;
+            }
+            return std::strtoll(buffer, nullptr, 10);
+        }
+
+        // Per-cpu maps return one value for every possible cpu, the highest cpu of the "0-7" style list plus one.
+        inline uint32_t GetPossibleCpuCount() noexcept
+        {
+            static const uint32_t possibleCpuCount = []() -> uint32_t {
+                char buffer[256]{};
+                int fd = open("/sys/devices/system/cpu/possible", (O_RDONLY | O_CLOEXEC));
+                if (fd < 0) {
+                    return 1;
+                }
+                auto len = read(fd, buffer, (sizeof(buffer) - 1));
+                close(fd);
+                while (len > 0 && (buffer[len - 1] < '0' || buffer[len - 1] > '9')) {
+                    len--;
+                }
+                auto pos = len;
+                while (pos > 0 && buffer[pos - 1] >= '0' && buffer[pos - 1] <= '9') {
+                    pos--;
+                }
+                return (pos < len) ? static_cast<uint32_t>(std::strtoul(buffer + pos, nullptr, 10) + 1) : 1;
+            }();
+            return possibleCpuCount;
+        }
+
+        // Called for every cpu on (re)attach, the sysfs path is built on the stack.
+        inline int ProgAttachTracePoint(int progFd, const std::string &tracePoint, int cpu = 0)
+        {
+            char idPath[PATH_MAX];
+            if (CU::FormatTo(idPath, sizeof(idPath), CU_FMT("/sys/kernel/tracing/events/{}/id"), tracePoint) >= sizeof(idPath)) {
+                return -1;
+            }
+            auto tracePointId = ReadSysValue(idPath);
+            if (tracePointId < 0) {
+                return -1;
+            }
             perf_event_attr perfEventAttr{};
-            perfEventAttr.config = CU::StrToULong(CU::ReadFile(CU::Format("/sys/kernel/tracing/events/{}/id", tracePoint)));
+            perfEventAttr.config = static_cast<uint64_t>(tracePointId);
             perfEventAttr.type = PERF_TYPE_TRACEPOINT;
             perfEventAttr.sample_period = 1;
             perfEventAttr.wakeup_events = 1;
-            int targetFd = syscall(__NR_perf_event_open, std::addressof(perfEventAttr), -1, 0, -1, 0);
-            if (targetFd < 0) {
+            return ProgAttachPerfEvent(progFd, perfEventAttr, cpu);
+        }
+
+        // Dynamic pmu types (kprobe, uprobe) are only exposed through sysfs.
+        inline int GetPmuType(const std::string &pmuName)
+        {
+            char typePath[PATH_MAX];
+            if (CU::FormatTo(typePath, sizeof(typePath), CU_FMT("/sys/bus/event_source/devices/{}/type"), pmuName) >= sizeof(typePath)) {
                 return -1;
             }
-            if (ioctl(targetFd, PERF_EVENT_IOC_SET_BPF, progFd) < 0) {
+            return static_cast<int>(ReadSysValue(typePath));
+        }
+
+        inline int ProgAttachKprobe(int progFd, const std::string &symbol, int cpu = 0)
+        {
+            int pmuType = GetPmuType("kprobe");
+            if (pmuType < 0) {
                 return -1;
             }
-            if (ioctl(targetFd, PERF_EVENT_IOC_ENABLE, 0) < 0) {
+            perf_event_attr perfEventAttr{};
+            perfEventAttr.size = sizeof(perfEventAttr);
+            perfEventAttr.type = static_cast<uint32_t>(pmuType);
+            perfEventAttr.kprobe_func = reinterpret_cast<uint64_t>(symbol.c_str());
+            perfEventAttr.probe_offset = 0;
+            perfEventAttr.sample_period = 1;
+            perfEventAttr.wakeup_events = 1;
+            return ProgAttachPerfEvent(progFd, perfEventAttr, cpu);
+        }
+
+        inline int ProgAttachUprobe(int progFd, const std::string &path, uint64_t offset, int cpu = 0)
+        {
+            int pmuType = GetPmuType("uprobe");
+            if (pmuType < 0) {
                 return -1;
             }
-            return targetFd;
+            perf_event_attr perfEventAttr{};
+            perfEventAttr.size = sizeof(perfEventAttr);
+            perfEventAttr.type = static_cast<uint32_t>(pmuType);
+            perfEventAttr.uprobe_path = reinterpret_cast<uint64_t>(path.c_str());
+            perfEventAttr.probe_offset = offset;
+            perfEventAttr.sample_period = 1;
+            perfEventAttr.wakeup_events = 1;
+            return ProgAttachPerfEvent(progFd, perfEventAttr, cpu);
+        }
+
+        inline int ProgAttachCpuClock(int progFd, uint64_t samplePeriodNs, int cpu)
+        {
+            perf_event_attr perfEventAttr{};
+            perfEventAttr.size = sizeof(perfEventAttr);
+            perfEventAttr.type = PERF_TYPE_SOFTWARE;
+            perfEventAttr.config = PERF_COUNT_SW_CPU_CLOCK;
+            perfEventAttr.sample_period = samplePeriodNs;
+            return ProgAttachPerfEvent(progFd, perfEventAttr, cpu);
+        }
+
+        inline bool GetProgInfo(int progFd, bpf_prog_info* progInfo)
+        {
+            bpf_attr attr{};
+            attr.info.bpf_fd = static_cast<uint32_t>(progFd);
+            attr.info.info_len = sizeof(bpf_prog_info);
+            attr.info.info = reinterpret_cast<uint64_t>(progInfo);
+            return (syscall(__NR_bpf, BPF_OBJ_GET_INFO_BY_FD, std::addressof(attr), sizeof(attr)) == 0);
+        }
+
+        inline uint32_t GetProgId(int progFd)
+        {
+            bpf_prog_info progInfo{};
+            if (!GetProgInfo(progFd, std::addressof(progInfo))) {
+                return 0;
+            }
+            return progInfo.id;
+        }
+
+        // Runs the program repeat times on ctx, duration receives the mean run time in ns.
+        // Returns the program's return value or -1 (errno set) if the program type has no test run support.
+        inline int ProgTestRun(int progFd, const void* ctx, uint32_t ctxSize, uint32_t repeat, uint32_t* duration)
+        {
+            bpf_attr attr{};
+            attr.test.prog_fd = static_cast<uint32_t>(progFd);
+            attr.test.ctx_in = reinterpret_cast<uint64_t>(ctx);
+            attr.test.ctx_size_in = ctxSize;
+            attr.test.repeat = repeat;
+            if (syscall(__NR_bpf, BPF_PROG_TEST_RUN, std::addressof(attr), sizeof(attr)) < 0) {
+                return -1;
+            }
+            if (duration != nullptr) {
+                *duration = attr.test.duration;
+            }
+            return static_cast<int>(attr.test.retval);
+        }
+
+        // Enables run_time_ns/run_cnt accounting of every bpf program while the returned fd stays open.
+        inline int EnableRunTimeStats()
+        {
+            bpf_attr attr{};
+            attr.enable_stats.type = BPF_STATS_RUN_TIME;
+            return static_cast<int>(syscall(__NR_bpf, BPF_ENABLE_STATS, std::addressof(attr), sizeof(attr)));
+        }
+
+        inline bool GetMapInfo(int mapFd, bpf_map_info* mapInfo)
+        {
+            bpf_attr attr{};
+            attr.info.bpf_fd = static_cast<uint32_t>(mapFd);
+            attr.info.info_len = sizeof(bpf_map_info);
+            attr.info.info = reinterpret_cast<uint64_t>(mapInfo);
+            return (syscall(__NR_bpf, BPF_OBJ_GET_INFO_BY_FD, std::addressof(attr), sizeof(attr)) == 0);
+        }
+
+        // Returns 1 if progId is attached to the tracepoint behind perfFd, 0 if not, -1 if the query failed.
+        inline int QueryProgAttached(int perfFd, uint32_t progId)
+        {
+            static constexpr uint32_t maxProgs = 64;
+
+            uint32_t queryBuffer[2 + maxProgs]{};
+            auto query = reinterpret_cast<perf_event_query_bpf*>(queryBuffer);
+            query->ids_len = maxProgs;
+            if (ioctl(perfFd, PERF_EVENT_IOC_QUERY_BPF, query) < 0) {
+                return -1;
+            }
+            for (uint32_t idx = 0; idx < std::min(query->prog_cnt, maxProgs); idx++) {
+                if (queryBuffer[2 + idx] == progId) {
+                    return 1;
+                }
+            }
+            return 0;
         }
 
         template <typename _Key_Ty, typename _Val_Ty>
@@ -110,6 +288,129 @@ namespace CU
             return elemValue;
         }
 
+        template <typename _Val_Ty>
+        inline uint32_t GetArrayValues(int fd, _Val_Ty* values, uint32_t count)
+        {
+            static constexpr uint32_t batchSize = 64;
+
+            uint32_t keys[batchSize]{};
+            uint32_t batchPos = 0;
+            uint32_t readCount = 0;
+            while (readCount < count) {
+                bpf_attr attr{};
+                attr.batch.in_batch = (readCount > 0) ? reinterpret_cast<uint64_t>(std::addressof(batchPos)) : 0;
+                attr.batch.out_batch = reinterpret_cast<uint64_t>(std::addressof(batchPos));
+                attr.batch.keys = reinterpret_cast<uint64_t>(keys);
+                attr.batch.values = reinterpret_cast<uint64_t>(values + readCount);
+                attr.batch.count = std::min(batchSize, count - readCount);
+                attr.batch.map_fd = static_cast<uint32_t>(fd);
+                int ret = static_cast<int>(syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, std::addressof(attr), sizeof(attr)));
+                if (ret < 0 && errno != ENOENT) {
+                    break;
+                }
+                readCount += attr.batch.count;
+                if (ret < 0 || attr.batch.count == 0) {
+                    return readCount;
+                }
+            }
+            for (uint32_t key = readCount; key < count; key++) {
+                bpf_attr attr{};
+                attr.map_fd = static_cast<uint32_t>(fd);
+                attr.key = reinterpret_cast<uint64_t>(std::addressof(key));
+                attr.value = reinterpret_cast<uint64_t>(values + key);
+                if (syscall(__NR_bpf, BPF_MAP_LOOKUP_ELEM, std::addressof(attr), sizeof(attr)) < 0) {
+                    return key;
+                }
+            }
+            return count;
+        }
+
+        // Reads the value of every possible cpu of one per-cpu map element, values needs GetPossibleCpuCount() entries.
+        template <typename _Key_Ty, typename _Val_Ty>
+        inline bool GetPerCpuElementValues(int fd, _Key_Ty key, _Val_Ty* values)
+        {
+            static_assert((sizeof(_Val_Ty) % 8) == 0, "per-cpu values are 8 byte aligned");
+
+            bpf_attr attr{};
+            attr.map_fd = static_cast<uint32_t>(fd);
+            attr.key = reinterpret_cast<uint64_t>(std::addressof(key));
+            attr.value = reinterpret_cast<uint64_t>(values);
+            return (syscall(__NR_bpf, BPF_MAP_LOOKUP_ELEM, std::addressof(attr), sizeof(attr)) == 0);
+        }
+
+        // Sums one per-cpu counter over every possible cpu, 0 if the lookup failed.
+        template <typename _Key_Ty>
+        inline uint64_t GetPerCpuElementSum(int fd, _Key_Ty key)
+        {
+            std::vector<uint64_t> values(GetPossibleCpuCount(), 0);
+            uint64_t sum = 0;
+            if (GetPerCpuElementValues(fd, key, values.data())) {
+                for (const auto &value : values) {
+                    sum += value;
+                }
+            }
+            return sum;
+        }
+
+        // Reads every element of a hash map with up to maxEntries elements, per-cpu maps have valueCount values
+        // (GetPossibleCpuCount()) per key. Uses BPF_MAP_LOOKUP_BATCH (5.6) and falls back to iterating the keys.
+        // Returns the element count, keys and values are resized to it.
+        template <typename _Key_Ty, typename _Val_Ty>
+        inline size_t GetHashElements(
+            int fd, std::vector<_Key_Ty> &keys, std::vector<_Val_Ty> &values, uint32_t maxEntries, uint32_t valueCount = 1)
+        {
+            keys.resize(maxEntries);
+            values.resize(static_cast<size_t>(maxEntries) * valueCount);
+            // The batch position of hash maps is a bucket index.
+            uint32_t batchPos = 0;
+            uint32_t readCount = 0;
+            bool batchFailed = false;
+            while (readCount < maxEntries) {
+                bpf_attr attr{};
+                attr.batch.in_batch = (readCount > 0) ? reinterpret_cast<uint64_t>(std::addressof(batchPos)) : 0;
+                attr.batch.out_batch = reinterpret_cast<uint64_t>(std::addressof(batchPos));
+                attr.batch.keys = reinterpret_cast<uint64_t>(keys.data() + readCount);
+                attr.batch.values = reinterpret_cast<uint64_t>(values.data() + static_cast<size_t>(readCount) * valueCount);
+                attr.batch.count = maxEntries - readCount;
+                attr.batch.map_fd = static_cast<uint32_t>(fd);
+                int ret = static_cast<int>(syscall(__NR_bpf, BPF_MAP_LOOKUP_BATCH, std::addressof(attr), sizeof(attr)));
+                if (ret < 0 && errno != ENOENT) {
+                    batchFailed = (readCount == 0);
+                    break;
+                }
+                readCount += attr.batch.count;
+                if (ret < 0 || attr.batch.count == 0) {
+                    break;
+                }
+            }
+            if (batchFailed) {
+                _Key_Ty key{};
+                _Key_Ty nextKey{};
+                bool hasKey = false;
+                while (readCount < maxEntries) {
+                    bpf_attr attr{};
+                    attr.map_fd = static_cast<uint32_t>(fd);
+                    attr.key = hasKey ? reinterpret_cast<uint64_t>(std::addressof(key)) : 0;
+                    attr.next_key = reinterpret_cast<uint64_t>(std::addressof(nextKey));
+                    if (syscall(__NR_bpf, BPF_MAP_GET_NEXT_KEY, std::addressof(attr), sizeof(attr)) < 0) {
+                        break;
+                    }
+                    key = nextKey;
+                    hasKey = true;
+                    attr = bpf_attr{};
+                    attr.map_fd = static_cast<uint32_t>(fd);
+                    attr.key = reinterpret_cast<uint64_t>(std::addressof(key));
+                    attr.value = reinterpret_cast<uint64_t>(values.data() + static_cast<size_t>(readCount) * valueCount);
+                    if (syscall(__NR_bpf, BPF_MAP_LOOKUP_ELEM, std::addressof(attr), sizeof(attr)) == 0) {
+                        keys[readCount++] = key;
+                    }
+                }
+            }
+            keys.resize(readCount);
+            values.resize(static_cast<size_t>(readCount) * valueCount);
+            return readCount;
+        }
+
         template <typename _Key_Ty, typename _Val_Ty>
         inline int SetElementValue(int fd, _Key_Ty key, _Val_Ty value, uint64_t flags)
         {
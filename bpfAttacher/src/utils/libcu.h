@@ -98,7 +98,7 @@ namespace CU
     CU_INLINE std::vector<std::basic_string<_Char_Ty>>
     StrSplit(const std::basic_string<_Char_Ty> &str, const std::basic_string<_Char_Ty> &delimiter)
     {
-        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() <= delimiter.size())) {
+        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() == 0)) {
             return {};
         }
         std::vector<std::basic_string<_Char_Ty>> splittedStrings{};
@@ -128,7 +128,7 @@ namespace CU
                 break;
             }
         }
-        if (CU_UNLIKELY(delimiter_size == 0 || str.size() <= delimiter_size)) {
+        if (CU_UNLIKELY(delimiter_size == 0 || str.size() == 0)) {
             return {};
         }
         std::vector<std::basic_string<_Char_Ty>> splittedStrings{};
@@ -151,19 +151,22 @@ namespace CU
     CU_INLINE std::vector<std::basic_string<_Char_Ty>>
     StrSplit(const std::basic_string<_Char_Ty> &str, _Char_Ty delimiter) 
     {
-        if (CU_UNLIKELY(str.size() <= 1)) {
+        if (CU_UNLIKELY(str.size() == 0)) {
             return {};
         }
         std::vector<std::basic_string<_Char_Ty>> splittedStrings{};
         size_t start_pos = 0;
         for (size_t pos = 0; pos < str.size(); pos++) {
-            if (str[pos] == delimiter || pos == (str.size() - 1)) {
+            if (str[pos] == delimiter) {
                 if (start_pos < pos) {
                     splittedStrings.emplace_back(str.substr(start_pos, (pos - start_pos)));
                 }
                 start_pos = pos + 1;
             }
         }
+        if (start_pos < str.size()) {
+            splittedStrings.emplace_back(str.substr(start_pos));
+        }
         return splittedStrings;
     }
 
@@ -171,7 +174,7 @@ namespace CU
     CU_INLINE std::basic_string<_Char_Ty>
     StrSplitAt(const std::basic_string<_Char_Ty> &str, const std::basic_string<_Char_Ty> &delimiter, int targetCount) 
     {
-        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() <= delimiter.size())) {
+        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() == 0)) {
             return {};
         }
         int count = 0;
@@ -204,7 +207,7 @@ namespace CU
                 break;
             }
         }
-        if (CU_UNLIKELY(delimiter_size == 0 || str.size() <= delimiter_size)) {
+        if (CU_UNLIKELY(delimiter_size == 0 || str.size() == 0)) {
             return {};
         }
         int count = 0;
@@ -230,13 +233,13 @@ namespace CU
     CU_INLINE std::basic_string<_Char_Ty> 
     StrSplitAt(const std::basic_string<_Char_Ty> &str, _Char_Ty delimiter, int targetCount) 
     {
-        if (CU_UNLIKELY(str.size() <= 1)) {
+        if (CU_UNLIKELY(str.size() == 0)) {
             return {};
         }
         int count = 0;
         size_t start_pos = 0;
         for (size_t pos = 0; pos < str.size(); pos++) {
-            if (str[pos] == delimiter || pos == (str.size() - 1)) {
+            if (str[pos] == delimiter) {
                 if (start_pos < pos) {
                     if (count == targetCount) {
                         return str.substr(start_pos, (pos - start_pos));
@@ -246,6 +249,9 @@ namespace CU
                 start_pos = pos + 1;
             }
         }
+        if (start_pos < str.size() && count == targetCount) {
+            return str.substr(start_pos);
+        }
         return {};
     }
 
@@ -253,7 +259,7 @@ namespace CU
     CU_INLINE std::basic_string<_Char_Ty>
     SubPrevStr(const std::basic_string<_Char_Ty> &str, const std::basic_string<_Char_Ty> &delimiter)
     {
-        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() <= delimiter.size())) {
+        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() == 0)) {
             return str;
         }
         return str.substr(0, str.find(delimiter));
@@ -278,7 +284,7 @@ namespace CU
     template <typename _Char_Ty>
     CU_INLINE std::basic_string<_Char_Ty> SubPrevStr(const std::basic_string<_Char_Ty> &str, _Char_Ty delimiter)
     {
-        if (CU_UNLIKELY(str.size() <= 1)) {
+        if (CU_UNLIKELY(str.size() == 0)) {
             return str;
         }
         for (size_t pos = 0; pos < str.size(); pos++) {
@@ -293,7 +299,7 @@ namespace CU
     CU_INLINE std::basic_string<_Char_Ty>
     SubRePrevStr(const std::basic_string<_Char_Ty> &str, const std::basic_string<_Char_Ty> &delimiter)
     {
-        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() <= delimiter.size())) {
+        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() == 0)) {
             return str;
         }
         return str.substr(0, str.rfind(delimiter));
@@ -318,12 +324,12 @@ namespace CU
     template <typename _Char_Ty>
     CU_INLINE std::basic_string<_Char_Ty> SubRePrevStr(const std::basic_string<_Char_Ty> &str, _Char_Ty delimiter)
     {
-        if (CU_UNLIKELY(str.size() <= 1)) {
+        if (CU_UNLIKELY(str.size() == 0)) {
             return str;
         }
-        for (size_t pos = (str.size() - 1); pos >= 0; pos--) {
-            if (str[pos] == delimiter) {
-                return str.substr(0, pos);
+        for (size_t pos = str.size(); pos > 0; pos--) {
+            if (str[pos - 1] == delimiter) {
+                return str.substr(0, (pos - 1));
             }
         }
         return str;
@@ -333,7 +339,7 @@ namespace CU
     CU_INLINE std::basic_string<_Char_Ty>
     SubPostStr(const std::basic_string<_Char_Ty> &str, const std::basic_string<_Char_Ty> &delimiter)
     {
-        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() <= delimiter.size())) {
+        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() == 0)) {
             return {};
         }
         auto sub_pos = str.find(delimiter);
@@ -354,7 +360,7 @@ namespace CU
                 break;
             }
         }
-        if (CU_UNLIKELY(delimiter_size == 0 || str.size() <= delimiter_size)) {
+        if (CU_UNLIKELY(delimiter_size == 0 || str.size() == 0)) {
             return {};
         }
         auto sub_pos = str.find(delimiter);
@@ -367,7 +373,7 @@ namespace CU
     template <typename _Char_Ty>
     CU_INLINE std::basic_string<_Char_Ty> SubPostStr(const std::basic_string<_Char_Ty> &str, _Char_Ty delimiter)
     {
-        if (CU_UNLIKELY(str.size() <= 1)) {
+        if (CU_UNLIKELY(str.size() == 0)) {
             return {};
         }
         for (size_t pos = 0; pos < (str.size() - 1); pos++) {
@@ -382,7 +388,7 @@ namespace CU
     CU_INLINE std::basic_string<_Char_Ty>
     SubRePostStr(const std::basic_string<_Char_Ty> &str, const std::basic_string<_Char_Ty> &delimiter)
     {
-        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() <= delimiter.size())) {
+        if (CU_UNLIKELY(delimiter.size() == 0 || str.size() == 0)) {
             return {};
         }
         auto sub_pos = str.rfind(delimiter);
@@ -403,7 +409,7 @@ namespace CU
                 break;
             }
         }
-        if (CU_UNLIKELY(delimiter_size == 0 || str.size() <= delimiter_size)) {
+        if (CU_UNLIKELY(delimiter_size == 0 || str.size() == 0)) {
             return {};
         }
         auto sub_pos = str.rfind(delimiter);
@@ -416,12 +422,12 @@ namespace CU
     template <typename _Char_Ty>
     CU_INLINE std::basic_string<_Char_Ty> SubRePostStr(const std::basic_string<_Char_Ty> &str, _Char_Ty delimiter)
     {
-        if (CU_UNLIKELY(str.size() <= 1)) {
+        if (CU_UNLIKELY(str.size() == 0)) {
             return {};
         }
-        for (size_t pos = (str.size() - 2); pos >= 0; pos--) {
-            if (str[pos] == delimiter) {
-                return str.substr(pos + 1);
+        for (size_t pos = (str.size() - 1); pos > 0; pos--) {
+            if (str[pos - 1] == delimiter) {
+                return str.substr(pos);
             }
         }
         return {};
@@ -0,0 +1,220 @@
+// BPF program microbenchmark by chenzyadb@github.com
+
+#include "BpfObject.h"
+#include <atomic>
+#include <sched.h>
+
+// Layout of the sched/sched_switch tracepoint context, as declared by the monitor programs.
+struct SchedSwitchArgs
+{
+    unsigned long long pad;
+    char prev_comm[16];
+    int prev_pid;
+    int prev_prio;
+    long long prev_state;
+    char next_comm[16];
+    int next_pid;
+    int next_prio;
+};
+
+struct BenchConfig
+{
+    std::string objectPath;
+    std::string progName;
+    std::string tracePoint;
+    uint32_t iterations;
+    uint32_t batch;
+    int durationSec;
+};
+
+std::string FormatNs(uint64_t tenthNs)
+{
+    return CU::Format("{}.{}ns", tenthNs / 10, tenthNs % 10);
+}
+
+// Values are in tenths of ns.
+void PrintDistribution(const std::string &title, std::vector<uint64_t> &values)
+{
+    if (values.size() == 0) {
+        CU::Println("[-] No samples.");
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    static const auto percentile = [](const std::vector<uint64_t> &sorted, size_t pct) -> uint64_t {
+        return sorted[(sorted.size() - 1) * pct / 100];
+    };
+    uint64_t sum = 0;
+    for (const auto &value : values) {
+        sum += value;
+    }
+    CU::Println("[+] {} ({} samples): mean={} min={} p50={} p90={} p99={} max={}", title, values.size(),
+        FormatNs(sum / values.size()), FormatNs(values.front()), FormatNs(percentile(values, 50)),
+        FormatNs(percentile(values, 90)), FormatNs(percentile(values, 99)), FormatNs(values.back()));
+}
+
+// BPF_PROG_TEST_RUN times batch runs of the program inside the kernel, each sample is the mean of one batch.
+bool BenchTestRun(int progFd, const BenchConfig &config)
+{
+    SchedSwitchArgs args[2]{};
+    args[0].prev_pid = 0;
+    args[0].next_pid = 1000;
+    args[1].prev_pid = 1000;
+    args[1].next_pid = 0;
+
+    std::vector<uint64_t> durations{};
+    durations.reserve(config.iterations / config.batch + 1);
+    for (uint32_t idx = 0; idx < config.iterations; idx += config.batch) {
+        uint32_t duration = 0;
+        const auto &ctx = args[(idx / config.batch) % 2];
+        if (CU::Bpf::ProgTestRun(progFd, std::addressof(ctx), sizeof(ctx), config.batch, std::addressof(duration)) < 0) {
+            return false;
+        }
+        durations.emplace_back(static_cast<uint64_t>(duration) * 10);
+    }
+    PrintDistribution(CU::Format("BPF_PROG_TEST_RUN, batch {}", config.batch), durations);
+    return true;
+}
+
+// Tracepoint programs have no test run support, attach the program for real and drive sched_switch with two
+// threads ping-ponging on one cpu, the kernel's run time stats give the mean cost per 10ms interval.
+bool BenchAttached(int progFd, const BenchConfig &config)
+{
+    static constexpr int intervalMs = 10;
+
+    int statsFd = CU::Bpf::EnableRunTimeStats();
+    if (statsFd < 0) {
+        // Kernels before 5.8 only have the sysctl.
+        CU::WriteFile("/proc/sys/kernel/bpf_stats_enabled", "1");
+    }
+    // Detaches the program and turns the stats off again, on every path out.
+    const auto cleanUp = [statsFd](int perfFd) {
+        if (perfFd >= 0) {
+            close(perfFd);
+        }
+        if (statsFd >= 0) {
+            close(statsFd);
+        } else {
+            CU::WriteFile("/proc/sys/kernel/bpf_stats_enabled", "0");
+        }
+    };
+    int perfFd = CU::Bpf::ProgAttachTracePoint(progFd, config.tracePoint);
+    if (perfFd < 0) {
+        CU::Println("[-] Failed to attach the program to tracepoint \"{}\".", config.tracePoint);
+        cleanUp(perfFd);
+        return false;
+    }
+
+    int pingPipe[2]{};
+    int pongPipe[2]{};
+    if (pipe(pingPipe) < 0) {
+        cleanUp(perfFd);
+        return false;
+    }
+    if (pipe(pongPipe) < 0) {
+        close(pingPipe[0]);
+        close(pingPipe[1]);
+        cleanUp(perfFd);
+        return false;
+    }
+    cpu_set_t cpuSet{};
+    CPU_ZERO(std::addressof(cpuSet));
+    CPU_SET(std::max(sched_getcpu(), 0), std::addressof(cpuSet));
+    std::atomic_bool running(true);
+    const auto pingPong = [&](int readFd, int writeFd, bool initiator) {
+        sched_setaffinity(0, sizeof(cpuSet), std::addressof(cpuSet));
+        char token = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            if (initiator && write(writeFd, std::addressof(token), 1) != 1) {
+                break;
+            }
+            if (read(readFd, std::addressof(token), 1) != 1) {
+                break;
+            }
+            if (!initiator && write(writeFd, std::addressof(token), 1) != 1) {
+                break;
+            }
+        }
+    };
+    std::thread pingThread(pingPong, pongPipe[0], pingPipe[1], true);
+    std::thread pongThread(pingPong, pingPipe[0], pongPipe[1], false);
+
+    std::vector<uint64_t> intervalMeans{};
+    bpf_prog_info prevInfo{};
+    CU::Bpf::GetProgInfo(progFd, std::addressof(prevInfo));
+    auto firstInfo = prevInfo;
+    auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(config.durationSec);
+    while (std::chrono::steady_clock::now() < endTime) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        bpf_prog_info progInfo{};
+        CU::Bpf::GetProgInfo(progFd, std::addressof(progInfo));
+        if (progInfo.run_cnt > prevInfo.run_cnt) {
+            intervalMeans.emplace_back((progInfo.run_time_ns - prevInfo.run_time_ns) * 10 / (progInfo.run_cnt - prevInfo.run_cnt));
+        }
+        prevInfo = progInfo;
+    }
+
+    running.store(false, std::memory_order_relaxed);
+    close(pingPipe[1]);
+    close(pongPipe[1]);
+    pingThread.join();
+    pongThread.join();
+    close(pingPipe[0]);
+    close(pongPipe[0]);
+    cleanUp(perfFd);
+
+    CU::Println("[+] {} runs in {}s.", prevInfo.run_cnt - firstInfo.run_cnt, config.durationSec);
+    PrintDistribution(CU::Format("Attached to \"{}\", mean per {}ms", config.tracePoint, intervalMs), intervalMeans);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig config{};
+    config.progName = "tracepoint_sched_sched_switch";
+    config.tracePoint = "sched/sched_switch";
+    config.iterations = 100000;
+    config.batch = 1;
+    config.durationSec = 5;
+
+    for (int idx = 1; idx < argc; idx++) {
+        std::string arg(argv[idx]);
+        if (arg == "--prog" && (idx + 1) < argc) {
+            config.progName = CU::Replace(std::string(argv[++idx]), '/', '_');
+        } else if (arg == "--tracepoint" && (idx + 1) < argc) {
+            config.tracePoint = argv[++idx];
+        } else if (arg == "--iterations" && (idx + 1) < argc) {
+            config.iterations = static_cast<uint32_t>(std::max(CU::StrToInt(argv[++idx]), 1));
+        } else if (arg == "--batch" && (idx + 1) < argc) {
+            config.batch = static_cast<uint32_t>(std::max(CU::StrToInt(argv[++idx]), 1));
+        } else if (arg == "--duration" && (idx + 1) < argc) {
+            config.durationSec = std::max(CU::StrToInt(argv[++idx]), 1);
+        } else if (arg.size() > 0 && arg[0] != '-' && config.objectPath.size() == 0) {
+            config.objectPath = arg;
+        } else {
+            CU::Println("[-] Invaild Arguments.");
+            return -1;
+        }
+    }
+    if (config.objectPath.size() == 0) {
+        CU::Println("Usage: bpfProgBench <object.o> [--prog <section>] [--iterations <n>] [--batch <n>]");
+        CU::Println("       [--tracepoint <category/name>] [--duration <sec>]");
+        return -1;
+    }
+
+    CU::InfinityRlLimit();
+    BpfObject bpfObject{};
+    if (!bpfObject.load(config.objectPath)) {
+        return -1;
+    }
+    int progFd = bpfObject.progFd(config.progName);
+    if (progFd < 0) {
+        CU::Println("[-] Program \"{}\" not found.", config.progName);
+        return -1;
+    }
+
+    if (BenchTestRun(progFd, config)) {
+        return 0;
+    }
+    CU::Println("[*] BPF_PROG_TEST_RUN is not supported for \"{}\" (errno={}), measuring attached.", config.progName, errno);
+    return BenchAttached(progFd, config) ? 0 : -1;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "utils/cu_libbpf.h"
+#include "utils/cu_elf.h"
+#include "utils/CuPairList.h"
+
+// Creates the maps and loads the programs of a bpf ELF object, pinning them is up to the caller.
+class BpfObject
+{
+    public:
+        struct Program
+        {
+            std::string name;
+            bpf_prog_type type;
+            int fd;
+        };
+
+        BpfObject() : name_(), license_("GPL"), maps_(), progs_() { }
+        BpfObject(const BpfObject &other) = delete;
+        BpfObject &operator=(const BpfObject &other) = delete;
+
+        ~BpfObject()
+        {
+            for (const auto &map : maps_) {
+                close(map.key());
+            }
+            for (const auto &prog : progs_) {
+                close(prog.fd);
+            }
+        }
+
+        bool load(const std::string &path)
+        {
+            if (!CU::StrEndsWith(path, ".o")) {
+                CU::Println("[-] Invalid bpf program file.");
+                return false;
+            }
+
+            name_ = CU::SubPrevStr(CU::SubRePostStr(path, '/'), ".o");
+            if (name_.size() == 0) {
+                CU::Println("[-] Failed to get bpf program name.");
+                return false;
+            }
+
+            auto sections = CU::Elf::ReadSections(path);
+            if (sections.size() == 0) {
+                CU::Println("[-] Failed to read sections.");
+                return false;
+            }
+
+            auto licenseSection = CU::Elf::GetSectionByName(sections, "license");
+            if (licenseSection.data.size() > 0) {
+                license_ = licenseSection.data.data();
+            }
+            CU::Println("[+] Bpf program license: \"{}\".", license_);
+
+            for (const auto &mapSection : GetSections_(sections, "bpf_map_")) {
+                auto bpfMapName = CU::SubPostStr(mapSection.name, "bpf_map_");
+                auto bpfMapDef = reinterpret_cast<const cu_bpf_map_def*>(mapSection.data.data());
+                int mapFd = CU::Bpf::CreateMap(bpfMapDef->type, bpfMapDef->key_size, bpfMapDef->value_size,
+                    bpfMapDef->max_entries, bpfMapDef->map_flags);
+                if (mapFd < 0) {
+                    CU::Println("[-] Failed to create map \"{}\".", bpfMapName);
+                    return false;
+                }
+                maps_.add(mapFd, bpfMapName);
+            }
+
+            for (const auto &progSection : GetSections_(sections, "bpf_prog_")) {
+                auto bpfProgType = GetProgType_(progSection);
+                auto bpfProgName = CU::Replace(CU::SubPostStr(progSection.name, "bpf_prog_"), '/', '_');
+                auto progInsns = GetProgInsns_(sections, progSection, maps_);
+                int progFd = CU::Bpf::LoadProgram(bpfProgType, reinterpret_cast<const bpf_insn*>(progInsns.data()),
+                    progInsns.size(), license_);
+                if (progFd < 0) {
+                    CU::Println("[-] Failed to load program \"{}\".", bpfProgName);
+                    return false;
+                }
+                progs_.emplace_back(Program{bpfProgName, bpfProgType, progFd});
+            }
+            return true;
+        }
+
+        // Pins maps at "<bpfPath>/map_<object>_<map>" and programs at "<bpfPath>/prog_<object>_<section>".
+        bool pin(const std::string &bpfPath)
+        {
+            for (const auto &map : maps_) {
+                auto bpfMapPath = CU::Format("{}/map_{}_{}", bpfPath, name_, map.value());
+                if (CU::IsPathExists(bpfMapPath)) {
+                    CU::Println("[-] Map \"{}\" already exists.", bpfMapPath);
+                    return false;
+                }
+                CU::Bpf::PinObject(map.key(), bpfMapPath);
+                CU::Println("[+] Successfully created map \"{}\".", map.value());
+            }
+
+            for (const auto &prog : progs_) {
+                auto bpfProgPath = CU::Format("{}/prog_{}_{}", bpfPath, name_, prog.name);
+                if (CU::IsPathExists(bpfProgPath)) {
+                    CU::Println("[-] Program \"{}\" already exists.", bpfProgPath);
+                    return false;
+                }
+                if (CU::Bpf::PinObject(prog.fd, bpfProgPath) < 0) {
+                    CU::Println("[-] Failed to pin object at \"{}\".", bpfProgPath);
+                    return false;
+                }
+                CU::Println("[+] Successfully loaded program \"{}\".", prog.name);
+            }
+            return true;
+        }
+
+        const std::string &name() const noexcept
+        {
+            return name_;
+        }
+
+        int mapFd(const std::string &mapName) const
+        {
+            return maps_.containsValue(mapName) ? maps_.atValue(mapName) : -1;
+        }
+
+        // The program name is its section name with '/' replaced by '_', e.g. "tracepoint_sched_sched_switch".
+        int progFd(const std::string &progName) const
+        {
+            for (const auto &prog : progs_) {
+                if (prog.name == progName) {
+                    return prog.fd;
+                }
+            }
+            return -1;
+        }
+
+        const std::vector<Program> &progs() const noexcept
+        {
+            return progs_;
+        }
+
+    private:
+        static CU::Elf::Sections GetSections_(const CU::Elf::Sections &sections, const std::string &prefix)
+        {
+            CU::Elf::Sections matchedSections{};
+            for (const auto &section : sections) {
+                if (section.type == SHT_PROGBITS && CU::StrStartsWith(section.name, prefix)) {
+                    matchedSections.emplace_back(section);
+                }
+            }
+            return matchedSections;
+        }
+
+        static bpf_prog_type GetProgType_(const CU::Elf::Section &section)
+        {
+            static const std::unordered_map<std::string, bpf_prog_type> progTypesMap = {
+                {"bpf_prog_skfilter", BPF_PROG_TYPE_SOCKET_FILTER},
+                {"bpf_prog_kprobe", BPF_PROG_TYPE_KPROBE},
+                {"bpf_prog_uprobe", BPF_PROG_TYPE_KPROBE},
+                {"bpf_prog_schedcls", BPF_PROG_TYPE_SCHED_CLS},
+                {"bpf_prog_tracepoint", BPF_PROG_TYPE_TRACEPOINT},
+                {"bpf_prog_xdp", BPF_PROG_TYPE_XDP},
+                {"bpf_prog_perf_event", BPF_PROG_TYPE_PERF_EVENT},
+                {"bpf_prog_cgroupskb", BPF_PROG_TYPE_CGROUP_SKB},
+                {"bpf_prog_cgroupsock", BPF_PROG_TYPE_CGROUP_SOCK}
+            };
+            for (const auto &[name, type] : progTypesMap) {
+                if (CU::StrStartsWith(section.name, name)) {
+                    return type;
+                }
+            }
+            return BPF_PROG_TYPE_UNSPEC;
+        }
+
+        static CU::Elf::Binary GetProgInsns_(
+            const CU::Elf::Sections &sections, const CU::Elf::Section &progSection, const CU::PairList<int, std::string> &bpfMaps)
+        {
+            auto progInsns = progSection.data;
+            auto rels = CU::Elf::GetSectionByName(sections, CU::Format(".rel{}", progSection.name)).data;
+            if (rels.size() > 0) {
+                auto strtab = CU::Elf::GetSectionByType(sections, SHT_STRTAB).data;
+                auto symtab = CU::Elf::GetSectionByType(sections, SHT_SYMTAB).data;
+                for (size_t idx = 0; idx < (rels.size() / sizeof(Elf64_Rel)); idx++) {
+                    auto rel = reinterpret_cast<const Elf64_Rel*>(&rels[sizeof(Elf64_Rel) * idx]);
+                    auto symbol = reinterpret_cast<const Elf64_Sym*>(&symtab[sizeof(Elf64_Sym) * ELF64_R_SYM(rel->r_info)]);
+                    auto symbolName = &strtab[symbol->st_name];
+                    if (bpfMaps.containsValue(symbolName)) {
+                        auto insn = reinterpret_cast<bpf_insn*>(&progInsns[rel->r_offset]);
+                        if (insn->code == (BPF_LD | BPF_IMM | BPF_DW)) {
+                            insn->imm = bpfMaps.atValue(symbolName);
+                            insn->src_reg = BPF_PSEUDO_MAP_FD;
+                        }
+                    }
+                }
+            }
+            return progInsns;
+        }
+
+        std::string name_;
+        std::string license_;
+        CU::PairList<int, std::string> maps_;
+        std::vector<Program> progs_;
+};
@@ -14,6 +14,11 @@
 #include <dirent.h>
 #include <sys/stat.h>
 
+// bionic exposes PAGE_SIZE, glibc does not.
+#ifndef PAGE_SIZE
+#define PAGE_SIZE 4096
+#endif
+
 #define CU_INLINE __attribute__((always_inline)) inline
 #define CU_LIKELY(val) (__builtin_expect(!!(val), 1))
 #define CU_UNLIKELY(val) (__builtin_expect(!!(val), 0))
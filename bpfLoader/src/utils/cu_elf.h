@@ -2,6 +2,7 @@
 
 #include "libcu.h"
 #include <cstdio>
+#include <cstring>
 #include <linux/elf.h>
 
 namespace CU 
@@ -40,37 +41,60 @@ namespace CU
         inline Sections ReadSections(const std::string &path)
         {
             auto rawData = ReadBinary(path);
-            if (rawData.size() == 0) {
+            if (rawData.size() < sizeof(Elf64_Ehdr) || std::memcmp(rawData.data(), ELFMAG, SELFMAG) != 0) {
                 return {};
             }
 
+            // Every header and section is bounds checked, a truncated or corrupted object yields no sections.
             auto elfHeader = reinterpret_cast<const Elf64_Ehdr*>(&rawData[0]);
-            if (elfHeader->e_ehsize == 0) {
+            if (elfHeader->e_ehsize == 0 || elfHeader->e_shentsize < sizeof(Elf64_Shdr) ||
+                elfHeader->e_shoff > rawData.size() ||
+                static_cast<size_t>(elfHeader->e_shentsize) * elfHeader->e_shnum > rawData.size() - elfHeader->e_shoff
+            ) {
                 return {};
             }
+            const auto getSectionHeader = [&](size_t idx) -> const Elf64_Shdr* {
+                return reinterpret_cast<const Elf64_Shdr*>(&rawData[elfHeader->e_shoff + elfHeader->e_shentsize * idx]);
+            };
+            const auto isInFile = [&](const Elf64_Shdr* sectionHeader) -> bool {
+                return (sectionHeader->sh_offset <= rawData.size() && sectionHeader->sh_size <= rawData.size() - sectionHeader->sh_offset);
+            };
 
-            const char* strtab = nullptr;
-            for (Elf64_Half idx = 0; idx < elfHeader->e_shnum; idx++) {
-                auto sectionHeaderOffset = elfHeader->e_shoff + elfHeader->e_shentsize * idx;
-                auto sectionHeader = reinterpret_cast<const Elf64_Shdr*>(&rawData[sectionHeaderOffset]);
-                if (sectionHeader->sh_type == SHT_STRTAB && sectionHeader->sh_offset > 0) {
-                    strtab = &rawData[sectionHeader->sh_offset];
-                    break;
+            // Prefer the section name table named by the header, fall back to the first string table.
+            const Elf64_Shdr* strtabHeader = nullptr;
+            if (elfHeader->e_shstrndx < elfHeader->e_shnum && getSectionHeader(elfHeader->e_shstrndx)->sh_type == SHT_STRTAB) {
+                strtabHeader = getSectionHeader(elfHeader->e_shstrndx);
+            } else {
+                for (Elf64_Half idx = 0; idx < elfHeader->e_shnum; idx++) {
+                    auto sectionHeader = getSectionHeader(idx);
+                    if (sectionHeader->sh_type == SHT_STRTAB && sectionHeader->sh_offset > 0) {
+                        strtabHeader = sectionHeader;
+                        break;
+                    }
                 }
             }
-            if (strtab == nullptr) {
+            if (strtabHeader == nullptr || strtabHeader->sh_offset == 0 || strtabHeader->sh_size == 0 || !isInFile(strtabHeader)) {
+                return {};
+            }
+            const char* strtab = &rawData[strtabHeader->sh_offset];
+            if (strtab[strtabHeader->sh_size - 1] != '\0') {
                 return {};
             }
 
             Sections sections(elfHeader->e_shnum);
             for (size_t idx = 0; idx < sections.size(); idx++) {
-                auto sectionHeaderOffset = elfHeader->e_shoff + elfHeader->e_shentsize * idx;
-                auto sectionHeader = reinterpret_cast<const Elf64_Shdr*>(&rawData[sectionHeaderOffset]);
+                auto sectionHeader = getSectionHeader(idx);
+                if (sectionHeader->sh_name >= strtabHeader->sh_size) {
+                    return {};
+                }
                 sections[idx].name = strtab + sectionHeader->sh_name;
                 sections[idx].type = sectionHeader->sh_type;
-                if (sectionHeader->sh_offset > 0 && sectionHeader->sh_size > 0) {
-                    sections[idx].data.insert(sections[idx].data.begin(), &rawData[sectionHeader->sh_offset], 
-                        &rawData[sectionHeader->sh_offset + sectionHeader->sh_size]);
+                if (sectionHeader->sh_type != SHT_NOBITS && sectionHeader->sh_offset > 0 && sectionHeader->sh_size > 0) {
+                    if (!isInFile(sectionHeader)) {
+                        return {};
+                    }
+                    sections[idx].data.insert(sections[idx].data.begin(), rawData.begin() + sectionHeader->sh_offset,
+                        rawData.begin() + sectionHeader->sh_offset + sectionHeader->sh_size);
                 }
             }
             return sections;
@@ -0,0 +1,180 @@
+// BPF Replay by chenzyadb@github.com
+
+#include "utils/libcu.h"
+#include "utils/CuFormat.h"
+#include "utils/cu_sched_trace.h"
+#include "utils/cu_util_account.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct ReplayConfig
+{
+    std::string tracePath;
+    size_t syntheticEvents;
+    uint32_t syntheticCpuCount;
+    uint64_t seed;
+    uint64_t monitoredCpuMask;
+    int repeat;
+};
+
+// Mirrors the maps of cu_util_monitor.c, last_sched_switch_ts_map is per-cpu and exists for every cpu,
+// the totals only for the first CU_UTIL_MAX_CPUS cpus.
+struct ReplayState
+{
+    cu_util_config config;
+    std::vector<uint64_t> lastSchedSwitchTs;
+    uint64_t idleTotalNs[CU_UTIL_MAX_CPUS];
+    uint64_t busyTotalNs[CU_UTIL_MAX_CPUS];
+};
+
+std::vector<cu_sched_switch_event> ReadTrace(const std::string &tracePath)
+{
+    std::vector<cu_sched_switch_event> events{};
+    int fd = open(tracePath.c_str(), (O_RDONLY | O_CLOEXEC));
+    if (fd < 0) {
+        return events;
+    }
+    struct stat st{};
+    if (fstat(fd, std::addressof(st)) < 0 || static_cast<size_t>(st.st_size) < sizeof(cu_sched_trace_header)) {
+        close(fd);
+        return events;
+    }
+    auto fileSize = static_cast<size_t>(st.st_size);
+    auto data = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return events;
+    }
+
+    cu_sched_trace_header header{};
+    std::memcpy(std::addressof(header), data, sizeof(header));
+    if (header.magic == CU_SCHED_TRACE_MAGIC && header.version == CU_SCHED_TRACE_VERSION &&
+        header.record_size >= sizeof(cu_sched_switch_event)
+    ) {
+        auto records = static_cast<const uint8_t*>(data) + sizeof(header);
+        size_t recordCount = (fileSize - sizeof(header)) / header.record_size;
+        events.resize(recordCount);
+        for (size_t idx = 0; idx < recordCount; idx++) {
+            std::memcpy(std::addressof(events[idx]), records + idx * header.record_size, sizeof(cu_sched_switch_event));
+        }
+    }
+    munmap(data, fileSize);
+    return events;
+}
+
+// Random switches between the idle task and up to 32767 tasks, 1us to 100us apart on each cpu.
+std::vector<cu_sched_switch_event> MakeSyntheticTrace(size_t eventCount, uint32_t cpuCount, uint64_t seed)
+{
+    static const auto nextRandom = [](uint64_t &state) -> uint64_t {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    std::vector<cu_sched_switch_event> events(eventCount);
+    std::vector<uint64_t> cpuTime(cpuCount, 1000000000);
+    std::vector<uint32_t> currentPid(cpuCount, 0);
+    uint64_t state = (seed != 0) ? seed : 1;
+    for (auto &event : events) {
+        auto random = nextRandom(state);
+        auto cpu = static_cast<uint32_t>(random % cpuCount);
+        cpuTime[cpu] += 1000 + (random >> 16) % 99000;
+        uint32_t nextPid = ((random >> 40) % 4 == 0) ? 0 : static_cast<uint32_t>(1 + (random >> 42) % 32767);
+        event.timestamp_ns = cpuTime[cpu];
+        event.prev_pid = currentPid[cpu];
+        event.next_pid = nextPid;
+        event.prev_state = 0;
+        event.cpu = static_cast<uint16_t>(cpu);
+        event.prev_prio = 120;
+        event.next_prio = 120;
+        currentPid[cpu] = nextPid;
+    }
+    return events;
+}
+
+void Replay(const std::vector<cu_sched_switch_event> &events, ReplayState &state)
+{
+    for (const auto &event : events) {
+        int cpu = event.cpu;
+        bool hasTotals = (cpu < CU_UTIL_MAX_CPUS);
+        cu_util_account_sched_switch(
+            std::addressof(state.config), cpu, event.timestamp_ns, event.prev_pid, std::addressof(state.lastSchedSwitchTs[cpu]),
+            (hasTotals ? std::addressof(state.idleTotalNs[cpu]) : nullptr), (hasTotals ? std::addressof(state.busyTotalNs[cpu]) : nullptr));
+    }
+}
+
+int ReplayMain(const ReplayConfig &config)
+{
+    std::vector<cu_sched_switch_event> events{};
+    if (config.tracePath.size() > 0) {
+        events = ReadTrace(config.tracePath);
+        if (events.size() == 0) {
+            CU::Println("[-] Failed to read trace \"{}\".", config.tracePath);
+            return -1;
+        }
+    } else {
+        events = MakeSyntheticTrace(config.syntheticEvents, config.syntheticCpuCount, config.seed);
+    }
+
+    ReplayState state{};
+    std::chrono::nanoseconds bestDuration = std::chrono::nanoseconds::max();
+    for (int round = 0; round < config.repeat; round++) {
+        state = ReplayState{};
+        state.config.ignored_cpu_mask = ~config.monitoredCpuMask;
+        state.lastSchedSwitchTs.resize(UINT16_MAX + 1, 0);
+        auto beginTime = std::chrono::steady_clock::now();
+        Replay(events, state);
+        auto duration = std::chrono::steady_clock::now() - beginTime;
+        bestDuration = std::min(bestDuration, std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+    }
+
+    for (int cpu = 0; cpu < CU_UTIL_MAX_CPUS; cpu++) {
+        if (state.busyTotalNs[cpu] > 0 || state.idleTotalNs[cpu] > 0) {
+            CU::Println("cpu{}: busy={}ns idle={}ns", cpu, state.busyTotalNs[cpu], state.idleTotalNs[cpu]);
+        }
+    }
+    auto durationNs = std::max<int64_t>(bestDuration.count(), 1);
+    CU::Println("[+] Replayed {} events in {}us, {} ns/event, {} Mevents/s (best of {}).",
+        events.size(), durationNs / 1000, static_cast<double>(durationNs) / events.size(),
+        static_cast<double>(events.size()) * 1000 / durationNs, config.repeat);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    ReplayConfig config{};
+    config.syntheticCpuCount = 8;
+    config.seed = 1;
+    config.monitoredCpuMask = UINT64_MAX;
+    config.repeat = 1;
+
+    for (int idx = 1; idx < argc; idx++) {
+        std::string arg(argv[idx]);
+        if (arg == "--synthetic" && (idx + 1) < argc) {
+            config.syntheticEvents = CU::StrToULong(argv[++idx]);
+        } else if (arg == "--cpu-count" && (idx + 1) < argc) {
+            config.syntheticCpuCount = static_cast<uint32_t>(std::min(std::max(CU::StrToInt(argv[++idx]), 1), UINT16_MAX + 1));
+        } else if (arg == "--seed" && (idx + 1) < argc) {
+            config.seed = CU::StrToULong(argv[++idx]);
+        } else if (arg == "--cpus" && (idx + 1) < argc) {
+            config.monitoredCpuMask = std::strtoull(argv[++idx], nullptr, 16);
+        } else if (arg == "--repeat" && (idx + 1) < argc) {
+            config.repeat = std::max(CU::StrToInt(argv[++idx]), 1);
+        } else if (arg.size() > 0 && arg[0] != '-' && config.tracePath.size() == 0) {
+            config.tracePath = arg;
+        } else {
+            CU::Println("[-] Invaild Arguments.");
+            return -1;
+        }
+    }
+    if (config.tracePath.size() == 0 && config.syntheticEvents == 0) {
+        CU::Println("Usage: bpfReplay <trace file> | --synthetic <events> [--cpu-count <n>] [--seed <n>]");
+        CU::Println("       [--cpus <hex mask>] [--repeat <n>]");
+        return -1;
+    }
+
+    return ReplayMain(config);
+}
@@ -0,0 +1,34 @@
+#ifndef __CU_SCHED_TRACE__
+#define __CU_SCHED_TRACE__ 1
+
+#include <stdint.h>
+
+#define CU_SCHED_TRACE_MAX_CPUS 16
+#define CU_SCHED_TRACE_RINGBUF_SIZE (1U << 22)
+
+// One sched_switch, emitted by cu_sched_trace.c and written unchanged (little endian) into trace files.
+struct cu_sched_switch_event
+{
+    uint64_t timestamp_ns;
+    uint32_t prev_pid;
+    uint32_t next_pid;
+    uint32_t prev_state;
+    uint16_t cpu;
+    uint8_t prev_prio;
+    uint8_t next_prio;
+};
+
+#define CU_SCHED_TRACE_MAGIC 0x54534355U // "CUST"
+#define CU_SCHED_TRACE_VERSION 1
+
+// Header of a trace file written by bpfAttacher --trace-output, followed by fixed-size records of record_size bytes.
+struct cu_sched_trace_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t cpu_count;
+    uint32_t clock_id;
+};
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef __CU_UTIL_ACCOUNT__
+#define __CU_UTIL_ACCOUNT__ 1
+
+// Accounting logic of cu_util_monitor.c, kept free of bpf helpers so it compiles both as bpf and as
+// plain C/C++ (bpfReplay runs recorded sched_switch streams through it).
+// The state pointers come from map lookups in bpf and may be NULL.
+
+#include "cu_util_monitor.h"
+#include <stddef.h>
+
+#ifndef CU_INLINE
+#define CU_INLINE __attribute__((always_inline)) inline
+#endif
+
+static CU_INLINE int cu_util_is_cpu_ignored(const struct cu_util_config* config, int cpu)
+{
+    if (config != NULL && cpu >= 0 && cpu < 64) {
+        return ((config->ignored_cpu_mask & (1ULL << cpu)) != 0);
+    }
+    return 0;
+}
+
+static CU_INLINE int cu_util_is_sampled_accounting(const struct cu_util_config* config)
+{
+    return (config != NULL && (config->flags & CU_UTIL_FLAG_SAMPLED_ACCOUNTING) != 0);
+}
+
+static CU_INLINE int cu_util_is_cgroup_accounting(const struct cu_util_config* config)
+{
+    return (config != NULL && (config->flags & CU_UTIL_FLAG_CGROUP_ACCOUNTING) != 0);
+}
+
+static CU_INLINE int cu_util_is_task_stats(const struct cu_util_config* config)
+{
+    return (config != NULL && (config->flags & CU_UTIL_FLAG_TASK_STATS) != 0);
+}
+
+static CU_INLINE int cu_util_is_wakeup_pairs(const struct cu_util_config* config)
+{
+    return (config != NULL && (config->flags & CU_UTIL_FLAG_WAKEUP_PAIRS) != 0);
+}
+
+static CU_INLINE int cu_util_is_offcpu_stats(const struct cu_util_config* config)
+{
+    return (config != NULL && (config->flags & CU_UTIL_FLAG_OFFCPU_STATS) != 0);
+}
+
+static CU_INLINE void cu_util_account_cpu_time(uint64_t interval, int idle, uint64_t* idle_total_ns, uint64_t* busy_total_ns)
+{
+    if (idle) {
+        if (idle_total_ns != NULL) {
+            *idle_total_ns += interval;
+        }
+    } else {
+        if (busy_total_ns != NULL) {
+            *busy_total_ns += interval;
+        }
+    }
+}
+
+// Charges the time since the previous switch on this cpu to the task switched out, pid 0 is the idle task.
+// Ignored cpus and sampled mode only keep the timestamp current, so a cpu accounted again later does not
+// charge the gap. Returns the charged interval, 0 if nothing was charged (also for the first switch on a cpu).
+static CU_INLINE uint64_t cu_util_account_sched_switch(
+    const struct cu_util_config* config, int cpu, uint64_t time, uint32_t prev_pid,
+    uint64_t* last_sched_switch_ts, uint64_t* idle_total_ns, uint64_t* busy_total_ns)
+{
+    if (last_sched_switch_ts == NULL) {
+        return 0;
+    }
+
+    uint64_t prev_sched_switch_ts = *last_sched_switch_ts;
+    if (time <= prev_sched_switch_ts) {
+        return 0;
+    }
+    *last_sched_switch_ts = time;
+    if (prev_sched_switch_ts == 0 || cu_util_is_sampled_accounting(config) || cu_util_is_cpu_ignored(config, cpu)) {
+        return 0;
+    }
+
+    uint64_t sched_switch_interval = time - prev_sched_switch_ts;
+    cu_util_account_cpu_time(sched_switch_interval, (prev_pid == 0), idle_total_ns, busy_total_ns);
+    return sched_switch_interval;
+}
+
+// Charges the time since the previous cpu-clock sample to the task running now.
+// Returns the charged interval, 0 if nothing was charged.
+static CU_INLINE uint64_t cu_util_account_cpu_clock(
+    const struct cu_util_config* config, int cpu, uint64_t time, uint32_t current_pid,
+    uint64_t* last_sample_ts, uint64_t* idle_total_ns, uint64_t* busy_total_ns)
+{
+    if (!cu_util_is_sampled_accounting(config) || cu_util_is_cpu_ignored(config, cpu) || last_sample_ts == NULL) {
+        return 0;
+    }
+
+    uint64_t prev_sample_ts = *last_sample_ts;
+    *last_sample_ts = time;
+    if (prev_sample_ts == 0 || time <= prev_sample_ts) {
+        return 0;
+    }
+
+    // Missed samples (throttling, hotplug) are charged as a single period.
+    uint64_t sample_interval = time - prev_sample_ts;
+    if (config->sample_period_ns > 0 && sample_interval > config->sample_period_ns * 2) {
+        sample_interval = config->sample_period_ns;
+    }
+    cu_util_account_cpu_time(sample_interval, (current_pid == 0), idle_total_ns, busy_total_ns);
+    return sample_interval;
+}
+
+static CU_INLINE uint32_t cu_util_prio_class(int prio)
+{
+    if (prio < CU_UTIL_MAX_RT_PRIO) {
+        return CU_UTIL_PRIO_CLASS_RT;
+    }
+    return (prio < CU_UTIL_BACKGROUND_PRIO) ? CU_UTIL_PRIO_CLASS_NORMAL : CU_UTIL_PRIO_CLASS_BACKGROUND;
+}
+
+// Adds the interval charged by cu_util_account_sched_switch() to the band of the task switched out.
+static CU_INLINE void cu_util_account_class_busy(
+    uint64_t interval, uint32_t prev_pid, int prev_prio, struct cu_util_class_busy* class_busy)
+{
+    if (interval == 0 || prev_pid == 0 || class_busy == NULL) {
+        return;
+    }
+
+    class_busy->busy_ns[cu_util_prio_class(prev_prio)] += interval;
+}
+
+// floor(log2()) by halving the width, loops are not allowed on older verifiers. 0 for 0.
+static CU_INLINE uint32_t cu_util_log2(uint64_t value)
+{
+    uint32_t result = 0;
+    uint32_t shift = (uint32_t)(value > 0xffffffffULL) << 5;
+    value >>= shift;
+    result |= shift;
+    shift = (uint32_t)(value > 0xffffU) << 4;
+    value >>= shift;
+    result |= shift;
+    shift = (uint32_t)(value > 0xffU) << 3;
+    value >>= shift;
+    result |= shift;
+    shift = (uint32_t)(value > 0xfU) << 2;
+    value >>= shift;
+    result |= shift;
+    shift = (uint32_t)(value > 0x3U) << 1;
+    value >>= shift;
+    result |= shift;
+    return (result | (uint32_t)(value >> 1));
+}
+
+static CU_INLINE uint32_t cu_util_slice_bucket(uint64_t slice_ns)
+{
+    uint32_t bucket = cu_util_log2(slice_ns / 1000);
+    return (bucket < CU_UTIL_SLICE_HIST_BUCKETS) ? bucket : (CU_UTIL_SLICE_HIST_BUCKETS - 1);
+}
+
+// Counts the slice charged by cu_util_account_sched_switch() in the histogram of the band of the task switched out,
+// the first switch on a cpu charges 0 and is not counted.
+static CU_INLINE void cu_util_account_slice(
+    uint64_t interval, uint32_t prev_pid, int prev_prio, struct cu_util_slice_hist* slice_hist)
+{
+    if (interval == 0 || prev_pid == 0 || slice_hist == NULL) {
+        return;
+    }
+
+    slice_hist->count[cu_util_prio_class(prev_prio)][cu_util_slice_bucket(interval)] += 1;
+}
+
+// Counts the switch out of prev_pid, a task still runnable was preempted, anything else went to sleep.
+static CU_INLINE void cu_util_account_switch_count(
+    const struct cu_util_config* config, int cpu, uint32_t prev_pid, uint64_t prev_state, struct cu_util_switch_counts* counts)
+{
+    if (cu_util_is_cpu_ignored(config, cpu) || prev_pid == 0 || counts == NULL) {
+        return;
+    }
+
+    if ((prev_state & CU_UTIL_TASK_STATE_SLEEP_MASK) == 0) {
+        counts->involuntary += 1;
+    } else {
+        counts->voluntary += 1;
+    }
+}
+
+// Counts a migration unless both cpus are ignored, returns 1 if it was counted.
+static CU_INLINE int cu_util_account_migration(
+    const struct cu_util_config* config, int orig_cpu, int dest_cpu, struct cu_util_migration_stats* stats)
+{
+    uint32_t src = (uint32_t)orig_cpu;
+    uint32_t dst = (uint32_t)dest_cpu;
+    if (stats == NULL || src >= CU_UTIL_MAX_CPUS || dst >= CU_UTIL_MAX_CPUS || src == dst) {
+        return 0;
+    }
+    if (cu_util_is_cpu_ignored(config, orig_cpu) && cu_util_is_cpu_ignored(config, dest_cpu)) {
+        return 0;
+    }
+
+    stats->count[src][dst] += 1;
+    return 1;
+}
+
+// Counts a wakeup issued on cpu for a task of target_cpu, returns 1 if it was counted.
+static CU_INLINE int cu_util_account_wakeup(
+    const struct cu_util_config* config, int cpu, int target_cpu, struct cu_util_wakeup_counts* counts)
+{
+    if (cu_util_is_cpu_ignored(config, cpu) || counts == NULL) {
+        return 0;
+    }
+
+    if (target_cpu == cpu) {
+        counts->local += 1;
+    } else {
+        counts->remote += 1;
+    }
+    return 1;
+}
+
+static CU_INLINE uint32_t cu_util_offcpu_state(uint64_t prev_state)
+{
+    uint64_t sleep_state = prev_state & CU_UTIL_TASK_STATE_SLEEP_MASK;
+    if (sleep_state == 0) {
+        return CU_UTIL_OFFCPU_RUNNABLE;
+    }
+    if ((sleep_state & CU_UTIL_TASK_STATE_INTERRUPTIBLE) != 0) {
+        return CU_UTIL_OFFCPU_INTERRUPTIBLE;
+    }
+    return ((sleep_state & CU_UTIL_TASK_STATE_UNINTERRUPTIBLE) != 0) ? CU_UTIL_OFFCPU_UNINTERRUPTIBLE : CU_UTIL_OFFCPU_OTHER;
+}
+
+// Stamps the task switched out, tasks leaving an ignored cpu are not stamped.
+static CU_INLINE void cu_util_account_switch_out(
+    const struct cu_util_config* config, int cpu, uint64_t time, uint64_t prev_state, struct cu_util_task_offcpu* offcpu)
+{
+    if (cu_util_is_cpu_ignored(config, cpu) || offcpu == NULL) {
+        return;
+    }
+
+    offcpu->switch_out_ts = time;
+    offcpu->switch_out_state = cu_util_offcpu_state(prev_state);
+}
+
+// Charges the time since the task was switched out to its state then. The stamp is always consumed, a task
+// switched in on an ignored cpu is charged nothing, so its time running there never counts as off-cpu.
+// Returns the charged interval, 0 if nothing was charged.
+static CU_INLINE uint64_t cu_util_account_switch_in(
+    const struct cu_util_config* config, int cpu, uint64_t time, struct cu_util_task_offcpu* offcpu)
+{
+    if (offcpu == NULL || offcpu->switch_out_ts == 0) {
+        return 0;
+    }
+
+    uint64_t switch_out_ts = offcpu->switch_out_ts;
+    uint32_t state = offcpu->switch_out_state;
+    offcpu->switch_out_ts = 0;
+    if (cu_util_is_cpu_ignored(config, cpu) || time <= switch_out_ts || state >= CU_UTIL_MAX_OFFCPU_STATES) {
+        return 0;
+    }
+
+    uint64_t off_cpu_interval = time - switch_out_ts;
+    offcpu->off_cpu_ns[state] += off_cpu_interval;
+    offcpu->off_cpu_count[state] += 1;
+    return off_cpu_interval;
+}
+
+static CU_INLINE int cu_util_is_task_exited(uint64_t prev_state)
+{
+    return ((prev_state & CU_UTIL_TASK_STATE_EXITED_MASK) != 0);
+}
+
+// Adds the counters of an exiting task to an aggregate, either stats may be missing. task_count is 1 only on
+// the last switch out of the task, so a task folded both by sched_process_exit and later is counted once.
+static CU_INLINE void cu_util_fold_exited_task(
+    const struct cu_util_task_stats* task_stats, const struct cu_util_task_offcpu* offcpu, uint64_t task_count,
+    struct cu_util_exited_stats* exited_stats)
+{
+    if (exited_stats == NULL || (task_stats == NULL && offcpu == NULL && task_count == 0)) {
+        return;
+    }
+
+    exited_stats->task_count += task_count;
+    if (task_stats != NULL) {
+        exited_stats->switches.voluntary += task_stats->switches.voluntary;
+        exited_stats->switches.involuntary += task_stats->switches.involuntary;
+        exited_stats->migrations += task_stats->migrations;
+    }
+    if (offcpu != NULL) {
+        exited_stats->off_cpu_ns[CU_UTIL_OFFCPU_RUNNABLE] += offcpu->off_cpu_ns[CU_UTIL_OFFCPU_RUNNABLE];
+        exited_stats->off_cpu_ns[CU_UTIL_OFFCPU_INTERRUPTIBLE] += offcpu->off_cpu_ns[CU_UTIL_OFFCPU_INTERRUPTIBLE];
+        exited_stats->off_cpu_ns[CU_UTIL_OFFCPU_UNINTERRUPTIBLE] += offcpu->off_cpu_ns[CU_UTIL_OFFCPU_UNINTERRUPTIBLE];
+        exited_stats->off_cpu_ns[CU_UTIL_OFFCPU_OTHER] += offcpu->off_cpu_ns[CU_UTIL_OFFCPU_OTHER];
+    }
+}
+
+// power/cpu_idle reports the entered state on idle entry and CU_UTIL_IDLE_STATE_EXIT on exit,
+// the time in between is charged to the entered state.
+static CU_INLINE void cu_util_account_cpu_idle(
+    const struct cu_util_config* config, int cpu, uint64_t time, uint32_t state, struct cu_util_idle_stats* idle_stats)
+{
+    if (cu_util_is_cpu_ignored(config, cpu) || idle_stats == NULL) {
+        return;
+    }
+
+    if (state != CU_UTIL_IDLE_STATE_EXIT) {
+        if (state < CU_UTIL_MAX_IDLE_STATES) {
+            idle_stats->entry_count[state] += 1;
+        }
+        idle_stats->entry_ts = time;
+        idle_stats->entry_state = state;
+        return;
+    }
+
+    uint32_t entry_state = idle_stats->entry_state;
+    if (idle_stats->entry_ts != 0 && time > idle_stats->entry_ts && entry_state < CU_UTIL_MAX_IDLE_STATES) {
+        idle_stats->residency_ns[entry_state] += time - idle_stats->entry_ts;
+    }
+    idle_stats->entry_ts = 0;
+}
+
+// irq/irq_handler_entry and irq/irq_handler_exit, hardirqs do not nest.
+static CU_INLINE void cu_util_account_hardirq(
+    const struct cu_util_config* config, int cpu, uint64_t time, uint32_t current_pid, int is_exit, struct cu_util_irq_stats* irq_stats)
+{
+    if (cu_util_is_cpu_ignored(config, cpu) || irq_stats == NULL) {
+        return;
+    }
+
+    if (!is_exit) {
+        irq_stats->hardirq_entry_ts = time;
+        return;
+    }
+
+    if (irq_stats->hardirq_entry_ts != 0 && time > irq_stats->hardirq_entry_ts) {
+        uint64_t irq_time = time - irq_stats->hardirq_entry_ts;
+        irq_stats->hardirq_ns += irq_time;
+        irq_stats->hardirq_count += 1;
+        if (current_pid == 0) {
+            irq_stats->idle_irq_ns += irq_time;
+        }
+    }
+    irq_stats->hardirq_entry_ts = 0;
+}
+
+// irq/softirq_entry and irq/softirq_exit, the hardirq time accumulated in between was nested in the softirq.
+static CU_INLINE void cu_util_account_softirq(
+    const struct cu_util_config* config, int cpu, uint64_t time, uint32_t current_pid, uint32_t vec, int is_exit,
+    struct cu_util_irq_stats* irq_stats)
+{
+    if (cu_util_is_cpu_ignored(config, cpu) || irq_stats == NULL) {
+        return;
+    }
+
+    if (!is_exit) {
+        irq_stats->softirq_entry_ts = time;
+        irq_stats->softirq_entry_vec = vec;
+        irq_stats->softirq_entry_hardirq_ns = irq_stats->hardirq_ns;
+        return;
+    }
+
+    if (irq_stats->softirq_entry_ts != 0 && time > irq_stats->softirq_entry_ts &&
+        vec == irq_stats->softirq_entry_vec && vec < CU_UTIL_MAX_SOFTIRQS
+    ) {
+        uint64_t softirq_time = time - irq_stats->softirq_entry_ts;
+        uint64_t nested_time = irq_stats->hardirq_ns - irq_stats->softirq_entry_hardirq_ns;
+        softirq_time = (softirq_time > nested_time) ? (softirq_time - nested_time) : 0;
+        irq_stats->softirq_ns[vec] += softirq_time;
+        irq_stats->softirq_count[vec] += 1;
+        if (current_pid == 0) {
+            irq_stats->idle_irq_ns += softirq_time;
+        }
+    }
+    irq_stats->softirq_entry_ts = 0;
+}
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef __CU_UTIL_MONITOR__
+#define __CU_UTIL_MONITOR__ 1
+
+#include <stdint.h>
+
+#define CU_UTIL_MAX_CPUS 16
+
+// Charge cpu time from perf_event/cpu_clock samples instead of sched_switch intervals.
+#define CU_UTIL_FLAG_SAMPLED_ACCOUNTING (1U << 0)
+// Charge busy time to the cgroup of the task as well, in cgroup_busy_ns_map.
+#define CU_UTIL_FLAG_CGROUP_ACCOUNTING (1U << 1)
+
+// Keep per-task statistics in task_stats_map.
+#define CU_UTIL_FLAG_TASK_STATS (1U << 2)
+// Count waker/wakee pairs in wakeup_pair_map.
+#define CU_UTIL_FLAG_WAKEUP_PAIRS (1U << 3)
+// Charge the time tasks spend switched out to their last state in task_offcpu_map.
+#define CU_UTIL_FLAG_OFFCPU_STATS (1U << 4)
+
+// Entries of cgroup_busy_ns_map (per-cpu hash, cgroup id to busy ns), bpfAttacher removes deleted cgroups.
+#define CU_UTIL_MAX_CGROUPS 1024
+// Entries of task_stats_map (LRU hash, pid to stats), the last switch out of a task removes its entry.
+#define CU_UTIL_MAX_TASKS 4096
+// Entries of wakeup_pair_map (LRU hash), the least recently woken pairs are evicted beyond it.
+#define CU_UTIL_MAX_WAKEUP_PAIRS 4096
+// Entries of task_offcpu_map (LRU hash, pid to off-cpu stats).
+#define CU_UTIL_MAX_OFFCPU_TASKS 8192
+// Entries of exited_uid_stats_map and exited_comm_stats_map (per-cpu LRU hashes).
+#define CU_UTIL_MAX_EXITED_GROUPS 1024
+
+// Sleeping states of sched_switch prev_state (TASK_REPORT), a task switched out without any of them
+// was preempted, newer kernels flag preemption with TASK_REPORT_MAX above them.
+#define CU_UTIL_TASK_STATE_SLEEP_MASK 0xffU
+#define CU_UTIL_TASK_STATE_INTERRUPTIBLE 0x1U
+#define CU_UTIL_TASK_STATE_UNINTERRUPTIBLE 0x2U
+// EXIT_DEAD and EXIT_ZOMBIE, set on the last switch out of an exiting task.
+#define CU_UTIL_TASK_STATE_EXITED_MASK 0x30U
+
+// Value of cpu_util_config_map, written by bpfAttacher before the programs are attached.
+struct cu_util_config
+{
+    uint64_t ignored_cpu_mask;
+    uint64_t sample_period_ns;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+#define CU_UTIL_MAX_IDLE_STATES 8
+// State of power/cpu_idle events leaving idle (PWR_EVENT_EXIT).
+#define CU_UTIL_IDLE_STATE_EXIT 0xffffffffU
+
+// Value of the per-cpu cpu_idle_stats_map, residency and entry count of every idle state of the cpu.
+// entry_ts and entry_state describe the idle period in progress, entry_ts is 0 while the cpu is not idle.
+struct cu_util_idle_stats
+{
+    uint64_t residency_ns[CU_UTIL_MAX_IDLE_STATES];
+    uint64_t entry_count[CU_UTIL_MAX_IDLE_STATES];
+    uint64_t entry_ts;
+    uint32_t entry_state;
+    uint32_t reserved;
+};
+
+// NR_SOFTIRQS, from HI_SOFTIRQ to RCU_SOFTIRQ.
+#define CU_UTIL_MAX_SOFTIRQS 10
+
+// Value of the per-cpu cpu_irq_stats_map. Softirq time excludes the hardirqs nested in it.
+// The sched_switch accounting charges interrupt time to the interrupted task, idle_irq_ns is the part of
+// hardirq_ns and softirq_ns that interrupted the idle task (and so counts as idle there).
+struct cu_util_irq_stats
+{
+    uint64_t hardirq_ns;
+    uint64_t hardirq_count;
+    uint64_t softirq_ns[CU_UTIL_MAX_SOFTIRQS];
+    uint64_t softirq_count[CU_UTIL_MAX_SOFTIRQS];
+    uint64_t idle_irq_ns;
+    uint64_t hardirq_entry_ts;
+    uint64_t softirq_entry_ts;
+    uint64_t softirq_entry_hardirq_ns;
+    uint32_t softirq_entry_vec;
+    uint32_t reserved;
+};
+
+// Priority bands of the kernel prio (0-99 rt and deadline, 100-139 is nice -20 to 19), background starts
+// at nice 10 (THREAD_PRIORITY_BACKGROUND on Android).
+#define CU_UTIL_PRIO_CLASS_RT 0
+#define CU_UTIL_PRIO_CLASS_NORMAL 1
+#define CU_UTIL_PRIO_CLASS_BACKGROUND 2
+#define CU_UTIL_MAX_PRIO_CLASSES 3
+#define CU_UTIL_MAX_RT_PRIO 100
+#define CU_UTIL_BACKGROUND_PRIO 130
+
+// Value of the per-cpu cpu_class_busy_ns_map, the sched_switch busy time split by the priority band of the task.
+struct cu_util_class_busy
+{
+    uint64_t busy_ns[CU_UTIL_MAX_PRIO_CLASSES];
+};
+
+// Buckets of the run slice histograms, bucket 0 counts slices below 2us, bucket n slices of [2^n, 2^(n+1)) us
+// and the last one everything longer.
+#define CU_UTIL_SLICE_HIST_BUCKETS 24
+
+// Value of the per-cpu cpu_slice_hist_map, lengths of the slices non-idle tasks ran before sched_switch,
+// per priority band.
+struct cu_util_slice_hist
+{
+    uint64_t count[CU_UTIL_MAX_PRIO_CLASSES][CU_UTIL_SLICE_HIST_BUCKETS];
+};
+
+// Context switches out of non-idle tasks, per cpu in cpu_switch_count_map and per task in task_stats_map.
+struct cu_util_switch_counts
+{
+    uint64_t voluntary;
+    uint64_t involuntary;
+};
+
+// Value of the per-cpu cpu_migration_stats_map, count[orig_cpu][dest_cpu] of sched_migrate_task.
+struct cu_util_migration_stats
+{
+    uint64_t count[CU_UTIL_MAX_CPUS][CU_UTIL_MAX_CPUS];
+};
+
+// Value of the per-cpu cpu_wakeup_count_map, wakeups issued by the cpu for a task whose cpu (the one it
+// last ran on, before the wakeup picks a runqueue) is the same cpu (local) or another one (remote).
+struct cu_util_wakeup_counts
+{
+    uint64_t local;
+    uint64_t remote;
+};
+
+// Key of wakeup_pair_map, the value is the wakeup count. sched_waking only has the pid of the wakee,
+// bpfAttacher resolves it to the tgid.
+struct cu_util_wakeup_key
+{
+    uint32_t waker_tgid;
+    uint32_t wakee_pid;
+};
+
+// Why a task was off cpu: preempted and waiting on a runqueue, sleeping (S), blocked in the kernel
+// (D, mostly I/O) or any other state (stopped, traced, dead).
+#define CU_UTIL_OFFCPU_RUNNABLE 0
+#define CU_UTIL_OFFCPU_INTERRUPTIBLE 1
+#define CU_UTIL_OFFCPU_UNINTERRUPTIBLE 2
+#define CU_UTIL_OFFCPU_OTHER 3
+#define CU_UTIL_MAX_OFFCPU_STATES 4
+
+// Value of task_offcpu_map. switch_out_ts and switch_out_state are stamped when the task is switched out,
+// the time until it is switched in again is charged to that state. switch_out_ts is 0 while it runs.
+struct cu_util_task_offcpu
+{
+    uint64_t off_cpu_ns[CU_UTIL_MAX_OFFCPU_STATES];
+    uint64_t off_cpu_count[CU_UTIL_MAX_OFFCPU_STATES];
+    uint64_t switch_out_ts;
+    uint32_t switch_out_state;
+    uint32_t tgid;
+    char comm[16];
+};
+
+struct cu_util_task_stats
+{
+    struct cu_util_switch_counts switches;
+    uint64_t migrations;
+    uint32_t tgid;
+    uint32_t reserved;
+    char comm[16];
+};
+
+// Key of exited_comm_stats_map.
+struct cu_util_comm_key
+{
+    char comm[16];
+};
+
+// Value of the per-cpu exited_uid_stats_map (keyed by uid) and exited_comm_stats_map, the counters of the
+// task_stats_map and task_offcpu_map entries of exited tasks, folded in by sched_process_exit and by the
+// last switch out of the task.
+struct cu_util_exited_stats
+{
+    uint64_t task_count;
+    struct cu_util_switch_counts switches;
+    uint64_t migrations;
+    uint64_t off_cpu_ns[CU_UTIL_MAX_OFFCPU_STATES];
+};
+
+#endif
@@ -15,15 +15,21 @@
 
 #define CU_KERNEL_VERSION(major, minor, sub) (((major) << 24) + ((minor) << 16) + (sub))
 
-static int (*bpf_map_set_elem)(const void* map, const void* key, const void* value, unsigned long long flags) 
+static __UNUSED int (*bpf_map_set_elem)(const void* map, const void* key, const void* value, unsigned long long flags) 
 = (int(*)(const void*, const void*, const void*, unsigned long long))BPF_FUNC_map_update_elem;
 
-static void* (*bpf_map_get_elem)(const void* map, const void* key) 
+static __UNUSED void* (*bpf_map_get_elem)(const void* map, const void* key) 
 = (void*(*)(const void*, const void*))BPF_FUNC_map_lookup_elem;
 
-static int (*bpf_map_remove_elem)(const void* map, const void* key) 
+static __UNUSED int (*bpf_map_remove_elem)(const void* map, const void* key) 
 = (int(*)(const void*, const void*))BPF_FUNC_map_delete_elem;
 
+static __UNUSED int (*bpf_ringbuf_output)(const void* ringbuf, const void* data, unsigned long long size, unsigned long long flags) 
+= (int(*)(const void*, const void*, unsigned long long, unsigned long long))BPF_FUNC_ringbuf_output;
+
+static __UNUSED int (*bpf_perf_event_output)(const void* ctx, const void* map, unsigned long long flags, const void* data, unsigned long long size) 
+= (int(*)(const void*, const void*, unsigned long long, const void*, unsigned long long))BPF_FUNC_perf_event_output;
+
 typedef struct {
     enum bpf_map_type type;
     unsigned int key_size;
@@ -57,14 +63,32 @@ typedef struct {
         return bpf_map_remove_elem(&map_name, key);                                                                   \
     }
 
+// Ring buffers have no key or value, buffer_size must be a power of 2 multiple of the page size.
+#define CU_DEFINE_BPF_RINGBUF(map_name, buffer_size)                                                                  \
+    const cu_bpf_map_def CU_SEC("bpf_map_" #map_name) map_name = {                                                    \
+        .type = BPF_MAP_TYPE_RINGBUF,                                                                                 \
+        .key_size = 0,                                                                                                \
+        .value_size = 0,                                                                                              \
+        .max_entries = (buffer_size),                                                                                 \
+        .map_flags = 0                                                                                                \
+    };                                                                                                                \
+                                                                                                                      \
+    static CU_INLINE __UNUSED int output_##map_name(const void* data, unsigned long long size, unsigned long long flags) \
+    {                                                                                                                 \
+        return bpf_ringbuf_output(&map_name, data, size, flags);                                                      \
+    }
+
 #define CU_DEFINE_BPF_PROG(sec_name, func_name) CU_SEC("bpf_prog_" sec_name) int func_name
 
-static unsigned long long (*bpf_ktime_get_ns)(void) = (unsigned long long(*)(void))BPF_FUNC_ktime_get_ns;
+static __UNUSED unsigned long long (*bpf_ktime_get_ns)(void) = (unsigned long long(*)(void))BPF_FUNC_ktime_get_ns;
+
+static __UNUSED unsigned long long (*bpf_get_current_pid_tgid)(void) = (unsigned long long(*)(void))BPF_FUNC_get_current_pid_tgid;
 
-static unsigned long long (*bpf_get_current_pid_tgid)(void) = (unsigned long long(*)(void))BPF_FUNC_get_current_pid_tgid;
+static __UNUSED unsigned long long (*bpf_get_current_uid_gid)(void) = (unsigned long long(*)(void))BPF_FUNC_get_current_uid_gid;
 
-static unsigned long long (*bpf_get_current_uid_gid)(void) = (unsigned long long(*)(void))BPF_FUNC_get_current_uid_gid;
+static __UNUSED unsigned long long (*bpf_get_smp_processor_id)(void) = (unsigned long long(*)(void))BPF_FUNC_get_smp_processor_id;
 
-static unsigned long long (*bpf_get_smp_processor_id)(void) = (unsigned long long(*)(void))BPF_FUNC_get_smp_processor_id;
+// Id of the cgroup v2 (default hierarchy) cgroup of the current task, kernel 4.18.
+static __UNUSED unsigned long long (*bpf_get_current_cgroup_id)(void) = (unsigned long long(*)(void))BPF_FUNC_get_current_cgroup_id;
 
 #endif
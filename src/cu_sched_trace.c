@@ -0,0 +1,62 @@
+// CuSchedTrace by chenzyadb@github.com
+
+#include "cu_bpf_def.h"
+#include "cu_sched_trace.h"
+
+// BPF ring buffers need kernel 5.8, build with -DCU_SCHED_TRACE_PERF_BUFFER for older kernels.
+#if defined(CU_SCHED_TRACE_PERF_BUFFER)
+CU_DEFINE_BPF_MAP(sched_switch_event_map, PERF_EVENT_ARRAY, int, uint32_t, CU_SCHED_TRACE_MAX_CPUS)
+#else
+CU_DEFINE_BPF_RINGBUF(sched_switch_event_map, CU_SCHED_TRACE_RINGBUF_SIZE)
+#endif
+CU_DEFINE_BPF_MAP(sched_switch_event_drop_map, PERCPU_ARRAY, int, uint64_t, 1)
+
+static CU_INLINE void count_sched_switch_event_drop(void)
+{
+    int key = 0;
+    uint64_t* drop_count_addr = get_sched_switch_event_drop_map_elem(&key);
+    if (drop_count_addr != NULL) {
+        *drop_count_addr += 1;
+    }
+}
+
+struct sched_switch_args 
+{
+    unsigned long long pad;
+    char prev_comm[16];
+    int prev_pid;
+    int prev_prio;
+    long long prev_state;
+    char next_comm[16];
+    int next_pid;
+    int next_prio;
+};
+
+CU_DEFINE_BPF_PROG("tracepoint/sched/sched_switch", trace_sched_switch)(struct sched_switch_args* args) 
+{
+    if (args == NULL) {
+        return 0;
+    }
+
+    struct cu_sched_switch_event event = {
+        .timestamp_ns = bpf_ktime_get_ns(),
+        .prev_pid = (uint32_t)args->prev_pid,
+        .next_pid = (uint32_t)args->next_pid,
+        .prev_state = (uint32_t)args->prev_state,
+        .cpu = (uint16_t)bpf_get_smp_processor_id(),
+        .prev_prio = (uint8_t)args->prev_prio,
+        .next_prio = (uint8_t)args->next_prio
+    };
+#if defined(CU_SCHED_TRACE_PERF_BUFFER)
+    int ret = bpf_perf_event_output(args, &sched_switch_event_map, BPF_F_CURRENT_CPU, &event, sizeof(event));
+#else
+    int ret = output_sched_switch_event_map(&event, sizeof(event), 0);
+#endif
+    if (ret != 0) {
+        count_sched_switch_event_drop();
+    }
+
+    return 0;
+}
+
+CU_LICENSE("GPL");
@@ -1,90 +1,416 @@
 // CuUtilMonitor V1 by chenzyadb@github.com
 
 #include "cu_bpf_def.h"
+#include "cu_util_monitor.h"
+#include "cu_util_account.h"
 
+CU_DEFINE_BPF_MAP(cpu_util_config_map, ARRAY, int, struct cu_util_config, 1)
 CU_DEFINE_BPF_MAP(last_sched_switch_ts_map, PERCPU_ARRAY, int, uint64_t, 1)
-CU_DEFINE_BPF_MAP(cpu_util_idle_total_ns_map, ARRAY, int, uint64_t, 16)
-CU_DEFINE_BPF_MAP(cpu_util_busy_total_ns_map, ARRAY, int, uint64_t, 16)
+CU_DEFINE_BPF_MAP(cpu_util_idle_total_ns_map, ARRAY, int, uint64_t, CU_UTIL_MAX_CPUS)
+CU_DEFINE_BPF_MAP(cpu_util_busy_total_ns_map, ARRAY, int, uint64_t, CU_UTIL_MAX_CPUS)
+CU_DEFINE_BPF_MAP(cpu_class_busy_ns_map, PERCPU_ARRAY, int, struct cu_util_class_busy, 1)
+CU_DEFINE_BPF_MAP(cpu_slice_hist_map, PERCPU_ARRAY, int, struct cu_util_slice_hist, 1)
 
-static CU_INLINE uint64_t get_last_sched_switch_ts(void)
+CU_DEFINE_BPF_MAP(last_cpu_clock_sample_ts_map, PERCPU_ARRAY, int, uint64_t, 1)
+
+CU_DEFINE_BPF_MAP(cgroup_busy_ns_map, PERCPU_HASH, uint64_t, uint64_t, CU_UTIL_MAX_CGROUPS)
+CU_DEFINE_BPF_MAP(cpu_switch_count_map, PERCPU_ARRAY, int, struct cu_util_switch_counts, 1)
+CU_DEFINE_BPF_MAP(task_stats_map, LRU_HASH, uint32_t, struct cu_util_task_stats, CU_UTIL_MAX_TASKS)
+CU_DEFINE_BPF_MAP(cpu_wakeup_count_map, PERCPU_ARRAY, int, struct cu_util_wakeup_counts, 1)
+CU_DEFINE_BPF_MAP(wakeup_pair_map, LRU_HASH, struct cu_util_wakeup_key, uint64_t, CU_UTIL_MAX_WAKEUP_PAIRS)
+CU_DEFINE_BPF_MAP(task_offcpu_map, LRU_HASH, uint32_t, struct cu_util_task_offcpu, CU_UTIL_MAX_OFFCPU_TASKS)
+CU_DEFINE_BPF_MAP(exited_uid_stats_map, LRU_PERCPU_HASH, uint32_t, struct cu_util_exited_stats, CU_UTIL_MAX_EXITED_GROUPS)
+CU_DEFINE_BPF_MAP(exited_comm_stats_map, LRU_PERCPU_HASH, struct cu_util_comm_key, struct cu_util_exited_stats, CU_UTIL_MAX_EXITED_GROUPS)
+
+CU_DEFINE_BPF_MAP(cpu_idle_stats_map, PERCPU_ARRAY, int, struct cu_util_idle_stats, 1)
+CU_DEFINE_BPF_MAP(cpu_irq_stats_map, PERCPU_ARRAY, int, struct cu_util_irq_stats, 1)
+CU_DEFINE_BPF_MAP(cpu_migration_stats_map, PERCPU_ARRAY, int, struct cu_util_migration_stats, 1)
+
+static CU_INLINE struct cu_util_config* get_cpu_util_config(void)
+{
+    int key = 0;
+    return get_cpu_util_config_map_elem(&key);
+}
+
+// Charges busy time to the cgroup of the current task, which is still the task switched out on sched_switch.
+static CU_INLINE void account_cgroup_busy_time(const struct cu_util_config* config, uint64_t interval)
+{
+    if (interval == 0 || !cu_util_is_cgroup_accounting(config)) {
+        return;
+    }
+
+    uint64_t cgroup_id = bpf_get_current_cgroup_id();
+    uint64_t* busy_ns = get_cgroup_busy_ns_map_elem(&cgroup_id);
+    if (busy_ns != NULL) {
+        *busy_ns += interval;
+    } else {
+        set_cgroup_busy_ns_map_elem(&cgroup_id, &interval, BPF_NOEXIST);
+    }
+}
+
+struct sched_switch_args 
+{
+    unsigned long long pad;
+    char prev_comm[16];
+    int prev_pid;
+    int prev_prio;
+    long long prev_state;
+    char next_comm[16];
+    int next_pid;
+    int next_prio;
+};
+
+struct sched_process_exit_args
+{
+    unsigned long long pad;
+    char comm[16];
+    int pid;
+    int prio;
+};
+
+static CU_INLINE struct cu_util_exited_stats* get_exited_uid_stats(uint32_t uid)
+{
+    struct cu_util_exited_stats* exited_stats = get_exited_uid_stats_map_elem(&uid);
+    if (exited_stats == NULL) {
+        struct cu_util_exited_stats new_exited_stats = {};
+        set_exited_uid_stats_map_elem(&uid, &new_exited_stats, BPF_NOEXIST);
+        exited_stats = get_exited_uid_stats_map_elem(&uid);
+    }
+    return exited_stats;
+}
+
+static CU_INLINE struct cu_util_exited_stats* get_exited_comm_stats(const struct cu_util_comm_key* comm_key)
+{
+    struct cu_util_exited_stats* exited_stats = get_exited_comm_stats_map_elem(comm_key);
+    if (exited_stats == NULL) {
+        struct cu_util_exited_stats new_exited_stats = {};
+        set_exited_comm_stats_map_elem(comm_key, &new_exited_stats, BPF_NOEXIST);
+        exited_stats = get_exited_comm_stats_map_elem(comm_key);
+    }
+    return exited_stats;
+}
+
+// Folds what is left in the per-task maps for the exiting task (the current one) into the aggregates of its
+// uid and comm and removes the entries.
+static CU_INLINE void fold_exited_task(uint32_t pid, const char* comm, uint64_t task_count)
+{
+    struct cu_util_task_stats* task_stats = get_task_stats_map_elem(&pid);
+    struct cu_util_task_offcpu* offcpu = get_task_offcpu_map_elem(&pid);
+    if (task_stats == NULL && offcpu == NULL && task_count == 0) {
+        return;
+    }
+
+    struct cu_util_comm_key comm_key = {};
+    __builtin_memcpy(comm_key.comm, comm, sizeof(comm_key.comm));
+    cu_util_fold_exited_task(task_stats, offcpu, task_count, get_exited_uid_stats((uint32_t)bpf_get_current_uid_gid()));
+    cu_util_fold_exited_task(task_stats, offcpu, task_count, get_exited_comm_stats(&comm_key));
+    if (task_stats != NULL) {
+        remove_task_stats_map_elem(&pid);
+    }
+    if (offcpu != NULL) {
+        remove_task_offcpu_map_elem(&pid);
+    }
+}
+
+// Stats of the task switched out, created on its first switch.
+static CU_INLINE struct cu_util_task_stats* get_prev_task_stats(const struct cu_util_config* config, const struct sched_switch_args* args)
+{
+    uint32_t pid = (uint32_t)args->prev_pid;
+    if (!cu_util_is_task_stats(config) || pid == 0) {
+        return NULL;
+    }
+
+    struct cu_util_task_stats* task_stats = get_task_stats_map_elem(&pid);
+    if (task_stats == NULL) {
+        struct cu_util_task_stats new_task_stats = {};
+        new_task_stats.tgid = (uint32_t)(bpf_get_current_pid_tgid() >> 32);
+        __builtin_memcpy(new_task_stats.comm, args->prev_comm, sizeof(new_task_stats.comm));
+        set_task_stats_map_elem(&pid, &new_task_stats, BPF_NOEXIST);
+        task_stats = get_task_stats_map_elem(&pid);
+    }
+    return task_stats;
+}
+
+// Stamps the task switched out and charges the off-cpu time of the task switched in. Tasks are only stamped
+// on monitored cpus, the switch in always consumes the stamp but charges nothing on an ignored cpu.
+// Exiting tasks are never stamped, their entry is already gone.
+static CU_INLINE void account_task_offcpu(const struct cu_util_config* config, int cpu, uint64_t time, const struct sched_switch_args* args)
+{
+    if (!cu_util_is_offcpu_stats(config)) {
+        return;
+    }
+
+    uint32_t prev_pid = (uint32_t)args->prev_pid;
+    if (prev_pid != 0 && !cu_util_is_cpu_ignored(config, cpu) && !cu_util_is_task_exited((uint64_t)args->prev_state)) {
+        struct cu_util_task_offcpu* prev_offcpu = get_task_offcpu_map_elem(&prev_pid);
+        if (prev_offcpu != NULL) {
+            cu_util_account_switch_out(config, cpu, time, (uint64_t)args->prev_state, prev_offcpu);
+        } else {
+            struct cu_util_task_offcpu new_offcpu = {};
+            new_offcpu.tgid = (uint32_t)(bpf_get_current_pid_tgid() >> 32);
+            __builtin_memcpy(new_offcpu.comm, args->prev_comm, sizeof(new_offcpu.comm));
+            cu_util_account_switch_out(config, cpu, time, (uint64_t)args->prev_state, &new_offcpu);
+            set_task_offcpu_map_elem(&prev_pid, &new_offcpu, BPF_NOEXIST);
+        }
+    }
+    uint32_t next_pid = (uint32_t)args->next_pid;
+    if (next_pid != 0) {
+        cu_util_account_switch_in(config, cpu, time, get_task_offcpu_map_elem(&next_pid));
+    }
+}
+
+CU_DEFINE_BPF_PROG("tracepoint/sched/sched_switch", trace_sched_switch)(struct sched_switch_args* args) 
 {
+    if (args == NULL) {
+        return 0;
+    }
+
+    // Ignored cpus only keep the switch timestamp current, unless per-task stats still have to consume
+    // off-cpu stamps and remove exiting tasks there.
     int key = 0;
-    uint64_t* last_sched_switch_ts_addr = get_last_sched_switch_ts_map_elem(&key);
-    if (last_sched_switch_ts_addr != NULL) {
-        return *last_sched_switch_ts_addr;
+    int cpu = (int)bpf_get_smp_processor_id();
+    const struct cu_util_config* config = get_cpu_util_config();
+    int cpu_ignored = cu_util_is_cpu_ignored(config, cpu);
+    int per_task_stats = (cu_util_is_task_stats(config) || cu_util_is_offcpu_stats(config));
+    uint32_t prev_pid = (uint32_t)args->prev_pid;
+    uint64_t prev_state = (uint64_t)args->prev_state;
+    uint64_t time = bpf_ktime_get_ns();
+    if (cpu_ignored || cu_util_is_sampled_accounting(config)) {
+        cu_util_account_sched_switch(config, cpu, time, prev_pid, get_last_sched_switch_ts_map_elem(&key), NULL, NULL);
+    } else {
+        uint64_t interval = cu_util_account_sched_switch(
+            config, cpu, time, prev_pid,
+            get_last_sched_switch_ts_map_elem(&key), get_cpu_util_idle_total_ns_map_elem(&cpu), get_cpu_util_busy_total_ns_map_elem(&cpu));
+        if (interval > 0 && prev_pid != 0) {
+            account_cgroup_busy_time(config, interval);
+            cu_util_account_class_busy(interval, prev_pid, args->prev_prio, get_cpu_class_busy_ns_map_elem(&key));
+            cu_util_account_slice(interval, prev_pid, args->prev_prio, get_cpu_slice_hist_map_elem(&key));
+        }
+    }
+    if (!cpu_ignored) {
+        cu_util_account_switch_count(config, cpu, prev_pid, prev_state, get_cpu_switch_count_map_elem(&key));
+    }
+    if (!per_task_stats) {
+        return 0;
+    }
+
+    if (cu_util_is_task_exited(prev_state)) {
+        // The last switch out of an exiting task, entries re-created while it slept after sched_process_exit
+        // (closing files, binder release) are folded here, and every exiting task is counted once.
+        if (prev_pid != 0) {
+            fold_exited_task(prev_pid, args->prev_comm, 1);
+        }
+    } else {
+        struct cu_util_task_stats* task_stats = get_prev_task_stats(config, args);
+        if (task_stats != NULL) {
+            cu_util_account_switch_count(config, cpu, prev_pid, prev_state, &task_stats->switches);
+        }
     }
+    account_task_offcpu(config, cpu, time, args);
+
     return 0;
 }
 
-static CU_INLINE void set_last_sched_switch_ts(uint64_t value)
+// Attached by bpfAttacher to a per-cpu software cpu-clock event, charges the time since the previous
+// sample to whatever the cpu is running now, so the cost is bounded by the sample rate.
+CU_DEFINE_BPF_PROG("perf_event/cpu_clock", sample_cpu_clock)(void* ctx)
 {
     int key = 0;
-    set_last_sched_switch_ts_map_elem(&key, &value, BPF_ANY);
+    int cpu = (int)bpf_get_smp_processor_id();
+    const struct cu_util_config* config = get_cpu_util_config();
+    if (!cu_util_is_sampled_accounting(config) || cu_util_is_cpu_ignored(config, cpu)) {
+        return 0;
+    }
+
+    uint32_t current_pid = (uint32_t)bpf_get_current_pid_tgid();
+    uint64_t interval = cu_util_account_cpu_clock(
+        config, cpu, bpf_ktime_get_ns(), current_pid,
+        get_last_cpu_clock_sample_ts_map_elem(&key), get_cpu_util_idle_total_ns_map_elem(&cpu), get_cpu_util_busy_total_ns_map_elem(&cpu));
+    if (interval > 0 && current_pid != 0) {
+        account_cgroup_busy_time(config, interval);
+    }
+
+    return 0;
 }
 
-static CU_INLINE uint64_t get_cpu_util_idle_total_ns(int cpu)
+struct cpu_idle_args
 {
-    uint64_t* cpu_util_idle_total_ns_addr = get_cpu_util_idle_total_ns_map_elem(&cpu);
-    if (cpu_util_idle_total_ns_addr != NULL) {
-        return *cpu_util_idle_total_ns_addr;
+    unsigned long long pad;
+    uint32_t state;
+    uint32_t cpu_id;
+};
+
+// Optional, attached with --add-tracepoint power/cpu_idle. The stats of all idle states of a cpu share one
+// per-cpu element, so a single lookup of key 0 returns the residency of every cpu.
+CU_DEFINE_BPF_PROG("tracepoint/power/cpu_idle", trace_cpu_idle)(struct cpu_idle_args* args)
+{
+    if (args == NULL) {
+        return 0;
     }
+
+    int key = 0;
+    cu_util_account_cpu_idle(
+        get_cpu_util_config(), (int)bpf_get_smp_processor_id(), bpf_ktime_get_ns(), args->state, get_cpu_idle_stats_map_elem(&key));
+
+    return 0;
+}
+
+struct irq_handler_args
+{
+    unsigned long long pad;
+    int irq;
+    int data;
+};
+
+struct softirq_args
+{
+    unsigned long long pad;
+    uint32_t vec;
+};
+
+static CU_INLINE struct cu_util_irq_stats* get_cpu_irq_stats(void)
+{
+    int key = 0;
+    return get_cpu_irq_stats_map_elem(&key);
+}
+
+// Optional, attached with --add-tracepoint irq/irq_handler_entry and irq/irq_handler_exit (and the softirq pair below).
+// In interrupt context the current task is the interrupted one.
+CU_DEFINE_BPF_PROG("tracepoint/irq/irq_handler_entry", trace_irq_handler_entry)(struct irq_handler_args* args)
+{
+    cu_util_account_hardirq(
+        get_cpu_util_config(), (int)bpf_get_smp_processor_id(), bpf_ktime_get_ns(), (uint32_t)bpf_get_current_pid_tgid(), 0, get_cpu_irq_stats());
+
     return 0;
 }
 
-static CU_INLINE void set_cpu_util_idle_total_ns(int cpu, uint64_t value)
+CU_DEFINE_BPF_PROG("tracepoint/irq/irq_handler_exit", trace_irq_handler_exit)(struct irq_handler_args* args)
 {
-    set_cpu_util_idle_total_ns_map_elem(&cpu, &value, BPF_ANY);
+    cu_util_account_hardirq(
+        get_cpu_util_config(), (int)bpf_get_smp_processor_id(), bpf_ktime_get_ns(), (uint32_t)bpf_get_current_pid_tgid(), 1, get_cpu_irq_stats());
+
+    return 0;
 }
 
-static CU_INLINE uint64_t get_cpu_util_busy_total_ns(int cpu)
+CU_DEFINE_BPF_PROG("tracepoint/irq/softirq_entry", trace_softirq_entry)(struct softirq_args* args)
 {
-    uint64_t* cpu_util_busy_total_ns_addr = get_cpu_util_busy_total_ns_map_elem(&cpu);
-    if (cpu_util_busy_total_ns_addr != NULL) {
-        return *cpu_util_busy_total_ns_addr;
+    if (args == NULL) {
+        return 0;
     }
+
+    cu_util_account_softirq(
+        get_cpu_util_config(), (int)bpf_get_smp_processor_id(), bpf_ktime_get_ns(), (uint32_t)bpf_get_current_pid_tgid(), args->vec, 0,
+        get_cpu_irq_stats());
+
     return 0;
 }
 
-static CU_INLINE void set_cpu_util_busy_total_ns(int cpu, uint64_t value)
+CU_DEFINE_BPF_PROG("tracepoint/irq/softirq_exit", trace_softirq_exit)(struct softirq_args* args)
 {
-    set_cpu_util_busy_total_ns_map_elem(&cpu, &value, BPF_ANY);
+    if (args == NULL) {
+        return 0;
+    }
+
+    cu_util_account_softirq(
+        get_cpu_util_config(), (int)bpf_get_smp_processor_id(), bpf_ktime_get_ns(), (uint32_t)bpf_get_current_pid_tgid(), args->vec, 1,
+        get_cpu_irq_stats());
+
+    return 0;
 }
 
-struct sched_switch_args 
+struct sched_migrate_task_args
 {
     unsigned long long pad;
-    char prev_comm[16];
-    int prev_pid;
-    int prev_prio;
-    long long prev_state;
-    char next_comm[16];
-    int next_pid;
-    int next_prio;
+    char comm[16];
+    int pid;
+    int prio;
+    int orig_cpu;
+    int dest_cpu;
 };
 
-CU_DEFINE_BPF_PROG("tracepoint/sched/sched_switch", trace_sched_switch)(struct sched_switch_args* args) 
+// Optional, attached with --add-tracepoint sched/sched_migrate_task. The event fires on whichever cpu moves the
+// task, the whole matrix is one per-cpu element like the idle and irq stats. Tasks are only counted once they
+// have an entry in task_stats_map, which is created on their own sched_switch where the tgid is known.
+CU_DEFINE_BPF_PROG("tracepoint/sched/sched_migrate_task", trace_sched_migrate_task)(struct sched_migrate_task_args* args)
 {
     if (args == NULL) {
         return 0;
     }
 
-    int cpu = (int)bpf_get_smp_processor_id();
-    uint64_t time = bpf_ktime_get_ns();
+    int key = 0;
+    const struct cu_util_config* config = get_cpu_util_config();
+    if (!cu_util_account_migration(config, args->orig_cpu, args->dest_cpu, get_cpu_migration_stats_map_elem(&key))) {
+        return 0;
+    }
+    if (cu_util_is_task_stats(config)) {
+        uint32_t pid = (uint32_t)args->pid;
+        struct cu_util_task_stats* task_stats = get_task_stats_map_elem(&pid);
+        if (task_stats != NULL) {
+            __sync_fetch_and_add(&task_stats->migrations, 1);
+        }
+    }
+
+    return 0;
+}
+
+struct sched_waking_args
+{
+    unsigned long long pad;
+    char comm[16];
+    int pid;
+    int prio;
+    int target_cpu;
+};
 
-    uint64_t sched_switch_interval = time - get_last_sched_switch_ts();
-    if (sched_switch_interval == 0) {
+// Optional, attached with --add-tracepoint sched/sched_waking. Unlike sched_wakeup, which fires on the target
+// cpu for queued (TTWU_QUEUE) wakeups, it always runs in the waker's context, so the waker is the current
+// task. Wakeups from interrupts are charged to the interrupted task and those from the idle task are not paired.
+// target_cpu is the cpu the wakee last ran on, the runqueue is only picked after the event.
+CU_DEFINE_BPF_PROG("tracepoint/sched/sched_waking", trace_sched_waking)(struct sched_waking_args* args)
+{
+    if (args == NULL) {
+        return 0;
+    }
+
+    int key = 0;
+    const struct cu_util_config* config = get_cpu_util_config();
+    if (!cu_util_account_wakeup(config, (int)bpf_get_smp_processor_id(), args->target_cpu, get_cpu_wakeup_count_map_elem(&key))) {
+        return 0;
+    }
+    uint64_t current_pid_tgid = bpf_get_current_pid_tgid();
+    if (!cu_util_is_wakeup_pairs(config) || (uint32_t)current_pid_tgid == 0) {
         return 0;
     }
-    set_last_sched_switch_ts(time);
 
-    if (args->prev_pid == 0) {
-        uint64_t cpu_util_idle_total_ns = get_cpu_util_idle_total_ns(cpu) + sched_switch_interval;
-        set_cpu_util_idle_total_ns(cpu, cpu_util_idle_total_ns);
+    struct cu_util_wakeup_key pair_key = {};
+    pair_key.waker_tgid = (uint32_t)(current_pid_tgid >> 32);
+    pair_key.wakee_pid = (uint32_t)args->pid;
+    uint64_t* count = get_wakeup_pair_map_elem(&pair_key);
+    if (count != NULL) {
+        __sync_fetch_and_add(count, 1);
     } else {
-        uint64_t cpu_util_busy_total_ns = get_cpu_util_busy_total_ns(cpu) + sched_switch_interval;
-        set_cpu_util_busy_total_ns(cpu, cpu_util_busy_total_ns);
+        uint64_t new_count = 1;
+        set_wakeup_pair_map_elem(&pair_key, &new_count, BPF_NOEXIST);
     }
-    
+
+    return 0;
+}
+
+// Optional, attached with --add-tracepoint sched/sched_process_exit. Folds the per-task entries of the exiting
+// task (the current one) into the aggregates of its uid and comm and removes them, so the per-task maps only
+// hold live tasks. Fires for every exiting thread. The task may still sleep later in do_exit and get new
+// entries, its last switch out folds and removes those and counts the task.
+CU_DEFINE_BPF_PROG("tracepoint/sched/sched_process_exit", trace_sched_process_exit)(struct sched_process_exit_args* args)
+{
+    if (args == NULL) {
+        return 0;
+    }
+
+    uint32_t pid = (uint32_t)args->pid;
+    if (pid != 0) {
+        fold_exited_task(pid, args->comm, 0);
+    }
+
     return 0;
 }
 
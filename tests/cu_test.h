@@ -0,0 +1,97 @@
+// Minimal unit test harness for the cuprum utils, each test_*.cpp is one executable registered with ctest.
+
+#pragma once
+
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <exception>
+
+namespace CuTest
+{
+    struct TestCase
+    {
+        const char* name;
+        void (*func)();
+    };
+
+    inline std::vector<TestCase> &Registry()
+    {
+        static std::vector<TestCase> registry{};
+        return registry;
+    }
+
+    inline int &Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool Register(const char* name, void (*func)())
+    {
+        Registry().emplace_back(TestCase{name, func});
+        return true;
+    }
+
+    inline void Fail(const char* file, int line, const std::string &message)
+    {
+        std::printf("  %s:%d: %s\n", file, line, message.c_str());
+        Failures()++;
+    }
+
+    inline int RunAll()
+    {
+        int failedTests = 0;
+        for (const auto &testCase : Registry()) {
+            int failuresBefore = Failures();
+            try {
+                testCase.func();
+            } catch (const std::exception &e) {
+                Fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+            }
+            bool passed = (Failures() == failuresBefore);
+            std::printf("[%s] %s\n", (passed ? "PASS" : "FAIL"), testCase.name);
+            failedTests += passed ? 0 : 1;
+        }
+        std::printf("%zu tests, %d failed.\n", Registry().size(), failedTests);
+        return (failedTests == 0) ? 0 : 1;
+    }
+}
+
+#define CU_TEST(name) \
+    static void name(); \
+    static const bool name##_registered = CuTest::Register(#name, name); \
+    static void name()
+
+#define CU_EXPECT(cond) \
+    do { \
+        if (!(cond)) { \
+            CuTest::Fail(__FILE__, __LINE__, "expected " #cond); \
+        } \
+    } while (0)
+
+#define CU_EXPECT_EQ(actual, expected) \
+    do { \
+        if (!((actual) == (expected))) { \
+            CuTest::Fail(__FILE__, __LINE__, "expected " #actual " == " #expected); \
+        } \
+    } while (0)
+
+#define CU_EXPECT_THROW(expr, except_type) \
+    do { \
+        bool thrown = false; \
+        try { \
+            (void)(expr); \
+        } catch (const except_type &) { \
+            thrown = true; \
+        } \
+        if (!thrown) { \
+            CuTest::Fail(__FILE__, __LINE__, "expected " #expr " to throw " #except_type); \
+        } \
+    } while (0)
+
+#define CU_TEST_MAIN() \
+    int main() \
+    { \
+        return CuTest::RunAll(); \
+    }
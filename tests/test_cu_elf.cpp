@@ -0,0 +1,145 @@
+#include "cu_test.h"
+#include "cu_elf.h"
+#include <unistd.h>
+
+namespace
+{
+    struct TestSection
+    {
+        std::string name;
+        Elf64_Word type;
+        std::string data;
+    };
+
+    // Lays out a relocatable ELF64: header, section data, section name table, section headers.
+    std::string BuildElf(const std::vector<TestSection> &sections)
+    {
+        std::string shstrtab(1, '\0');
+        std::vector<Elf64_Shdr> headers(sections.size() + 2);
+        std::string body{};
+        size_t offset = sizeof(Elf64_Ehdr);
+        for (size_t idx = 0; idx < sections.size(); idx++) {
+            auto &header = headers[idx + 1];
+            header.sh_name = shstrtab.size();
+            header.sh_type = sections[idx].type;
+            header.sh_offset = offset + body.size();
+            header.sh_size = sections[idx].data.size();
+            shstrtab += sections[idx].name + '\0';
+            body += sections[idx].data;
+        }
+        auto &shstrtabHeader = headers.back();
+        shstrtabHeader.sh_name = shstrtab.size();
+        shstrtab += std::string(".shstrtab") + '\0';
+        shstrtabHeader.sh_type = SHT_STRTAB;
+        shstrtabHeader.sh_offset = offset + body.size();
+        shstrtabHeader.sh_size = shstrtab.size();
+        body += shstrtab;
+
+        Elf64_Ehdr elfHeader{};
+        std::memcpy(elfHeader.e_ident, ELFMAG, SELFMAG);
+        elfHeader.e_ident[EI_CLASS] = ELFCLASS64;
+        elfHeader.e_type = ET_REL;
+        elfHeader.e_machine = EM_BPF;
+        elfHeader.e_ehsize = sizeof(Elf64_Ehdr);
+        elfHeader.e_shoff = offset + body.size();
+        elfHeader.e_shentsize = sizeof(Elf64_Shdr);
+        elfHeader.e_shnum = headers.size();
+        elfHeader.e_shstrndx = headers.size() - 1;
+
+        std::string image(reinterpret_cast<const char*>(std::addressof(elfHeader)), sizeof(elfHeader));
+        image += body;
+        image.append(reinterpret_cast<const char*>(headers.data()), headers.size() * sizeof(Elf64_Shdr));
+        return image;
+    }
+
+    std::string WriteTemp(const std::string &content)
+    {
+        char path[] = "/tmp/test_cu_elf_XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            return "";
+        }
+        auto written = write(fd, content.data(), content.size());
+        close(fd);
+        return (written == static_cast<ssize_t>(content.size())) ? path : "";
+    }
+
+    CU::Elf::Sections ReadImage(const std::string &image)
+    {
+        auto path = WriteTemp(image);
+        auto sections = CU::Elf::ReadSections(path);
+        unlink(path.c_str());
+        return sections;
+    }
+
+    const std::vector<TestSection> testSections = {
+        {".strtab", SHT_STRTAB, std::string("\0cpu_util_map\0", 14)},
+        {"license", SHT_PROGBITS, std::string("GPL\0", 4)},
+        {"bpf_map_cpu_util_map", SHT_PROGBITS, std::string(20, '\x01')}
+    };
+}
+
+CU_TEST(ReadsSections)
+{
+    auto sections = ReadImage(BuildElf(testSections));
+    CU_EXPECT_EQ(sections.size(), 5U);
+    if (sections.size() != 5) {
+        return;
+    }
+    CU_EXPECT_EQ(sections[0].name, "");
+    CU_EXPECT_EQ(sections[2].name, "license");
+    CU_EXPECT_EQ(sections[4].name, ".shstrtab");
+    auto license = CU::Elf::GetSectionByName(sections, "license");
+    CU_EXPECT_EQ(license.type, static_cast<Elf64_Word>(SHT_PROGBITS));
+    CU_EXPECT_EQ(std::string(license.data.data()), "GPL");
+    CU_EXPECT_EQ(CU::Elf::GetSectionByName(sections, "bpf_map_cpu_util_map").data.size(), 20U);
+}
+
+CU_TEST(SectionLookup)
+{
+    auto sections = ReadImage(BuildElf(testSections));
+    CU_EXPECT_EQ(CU::Elf::GetSectionByType(sections, SHT_STRTAB).name, ".strtab");
+    CU_EXPECT_EQ(CU::Elf::GetSectionByName(sections, "missing").data.size(), 0U);
+    CU_EXPECT_EQ(CU::Elf::GetSectionByType(sections, SHT_SYMTAB).name, "");
+}
+
+CU_TEST(MissingFile)
+{
+    CU_EXPECT_EQ(CU::Elf::ReadSections("/nonexistent/object.o").size(), 0U);
+    CU_EXPECT_EQ(CU::Elf::ReadBinary("/nonexistent/object.o").size(), 0U);
+}
+
+CU_TEST(RejectsMalformed)
+{
+    auto image = BuildElf(testSections);
+    CU_EXPECT_EQ(ReadImage("").size(), 0U);
+    CU_EXPECT_EQ(ReadImage("not an elf file").size(), 0U);
+
+    // Truncated anywhere, the section headers live at the end of the file.
+    for (size_t size = 1; size < image.size(); size += 7) {
+        CU_EXPECT_EQ(ReadImage(image.substr(0, size)).size(), 0U);
+    }
+
+    auto badMagic = image;
+    badMagic[1] = 'X';
+    CU_EXPECT_EQ(ReadImage(badMagic).size(), 0U);
+
+    auto badOffset = image;
+    auto elfHeader = reinterpret_cast<Elf64_Ehdr*>(&badOffset[0]);
+    auto sectionHeader = reinterpret_cast<Elf64_Shdr*>(&badOffset[elfHeader->e_shoff + sizeof(Elf64_Shdr) * 3]);
+    sectionHeader->sh_offset = image.size() - 4;
+    CU_EXPECT_EQ(ReadImage(badOffset).size(), 0U);
+
+    auto badName = image;
+    elfHeader = reinterpret_cast<Elf64_Ehdr*>(&badName[0]);
+    sectionHeader = reinterpret_cast<Elf64_Shdr*>(&badName[elfHeader->e_shoff + sizeof(Elf64_Shdr) * 2]);
+    sectionHeader->sh_name = 0xffff;
+    CU_EXPECT_EQ(ReadImage(badName).size(), 0U);
+
+    auto badShnum = image;
+    elfHeader = reinterpret_cast<Elf64_Ehdr*>(&badShnum[0]);
+    elfHeader->e_shnum = 0xfff;
+    CU_EXPECT_EQ(ReadImage(badShnum).size(), 0U);
+}
+
+CU_TEST_MAIN()
@@ -0,0 +1,214 @@
+#include "cu_test.h"
+#include "CuFormat.h"
+#include <cmath>
+#include <limits>
+
+CU_TEST(SequentialArgs)
+{
+    CU_EXPECT_EQ(CU::Format("{} + {} = {}", 1, 2, 3), "1 + 2 = 3");
+    CU_EXPECT_EQ(CU::Format("[+] Map \"{}\" created.", std::string("cpu_util_map")), "[+] Map \"cpu_util_map\" created.");
+    CU_EXPECT_EQ(CU::Format("{}{}", "a", 'b'), "ab");
+    CU_EXPECT_EQ(CU::Format("no args"), "no args");
+    CU_EXPECT_EQ(CU::Format(""), "");
+}
+
+CU_TEST(IndexedArgs)
+{
+    CU_EXPECT_EQ(CU::Format("{1} {0} {1}", "a", "b"), "b a b");
+    CU_EXPECT_EQ(CU::Format("{0:2}|{1}", "abcdef", 7), "ab|7");
+}
+
+CU_TEST(MaxLength)
+{
+    CU_EXPECT_EQ(CU::Format("{:3}", "abcdef"), "abc");
+    CU_EXPECT_EQ(CU::Format("{:10}", "abc"), "abc");
+    CU_EXPECT_EQ(CU::Format("{:0}x", "abc"), "x");
+}
+
+CU_TEST(EscapedBraces)
+{
+    CU_EXPECT_EQ(CU::Format("{{}} {}", 1), "{} 1");
+    CU_EXPECT_EQ(CU::Format("{{{}}}", 2), "{2}");
+}
+
+CU_TEST(InvalidFormatThrows)
+{
+    CU_EXPECT_THROW(CU::Format("{x}", 1), CU::FormatExcept);
+    CU_EXPECT_THROW(CU::Format("a } b", 1), CU::FormatExcept);
+    CU_EXPECT_THROW(CU::Format("{:3", "abc"), CU::FormatExcept);
+    CU_EXPECT_THROW(CU::Format("{} {}", 1), CU::FormatExcept);
+    CU_EXPECT_THROW(CU::Format("{5}", 1), CU::FormatExcept);
+}
+
+CU_TEST(Integers)
+{
+    CU_EXPECT_EQ(CU::Format("{}", 0), "0");
+    CU_EXPECT_EQ(CU::Format("{}", -1234), "-1234");
+    CU_EXPECT_EQ(CU::Format("{}", INT64_MAX), "9223372036854775807");
+    CU_EXPECT_EQ(CU::Format("{}", INT64_MIN), "-9223372036854775808");
+    CU_EXPECT_EQ(CU::Format("{}", INT32_MIN), "-2147483648");
+    CU_EXPECT_EQ(CU::Format("{}", UINT64_MAX), "18446744073709551615");
+    CU_EXPECT_EQ(CU::Format("{}", static_cast<unsigned char>(200)), "200");
+    CU_EXPECT_EQ(CU::Format("{}", static_cast<short>(-7)), "-7");
+    CU_EXPECT_EQ(CU::Format("{} {}", true, false), "true false");
+}
+
+CU_TEST(Floats)
+{
+    CU_EXPECT_EQ(CU::Format("{}", 2.5), "2.5");
+    CU_EXPECT_EQ(CU::Format("{}", -0.25), "-0.25");
+    CU_EXPECT_EQ(CU::Format("{}", 0.0), "0.0");
+    CU_EXPECT_EQ(CU::Format("{}", 12.0f), "12.0");
+}
+
+CU_TEST(Pointers)
+{
+    CU_EXPECT_EQ(CU::Format("{}", nullptr), "NULL");
+    const int* ptr = nullptr;
+    CU_EXPECT_EQ(CU::Format("{}", ptr), "NULL");
+}
+
+CU_TEST(LongStrings)
+{
+    // Past the inline buffer of _Format_String, forces the heap path.
+    std::string longStr(1000, 'x');
+    auto result = CU::Format("<{}|{}>", longStr, longStr);
+    CU_EXPECT_EQ(result.size(), 2003U);
+    CU_EXPECT_EQ(result, "<" + longStr + "|" + longStr + ">");
+    CU_EXPECT_EQ(CU::Format(("{}" + longStr).c_str(), 1), "1" + longStr);
+}
+
+CU_TEST(ToStringAndCFormat)
+{
+    CU_EXPECT_EQ(CU::To_String(42), "42");
+    CU_EXPECT_EQ(CU::To_String('c'), "c");
+    CU_EXPECT_EQ(CU::CFormat("%d-%s", 5, "x"), "5-x");
+    CU_EXPECT_EQ(CU::CFormat("%s", ""), "");
+}
+
+CU_TEST(CompiledFormat)
+{
+    const std::string mapName("cpu_util_map");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}/map_{}_{}"), "/sys/fs/bpf", std::string("CuUtilMonitor"), mapName),
+        "/sys/fs/bpf/map_CuUtilMonitor_cpu_util_map");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{} + {} = {}"), 1, 2u, 3.5), "1 + 2 = 3.5");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{1} {0} {1}"), "a", "b"), "b a b");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{0:2}|{1}|{:3}"), "abcdef", 7, mapName), "ab|7|cpu");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{{}} {{{}}} }}"), 2), "{} {2} }");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}{}"), 'c', true), "ctrue");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{} {}"), nullptr, static_cast<const char*>(nullptr)), "NULL NULL");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("no args")), "no args");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("")), "");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("trailing {")), "trailing {");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), std::string(1000, 'x')), std::string(1000, 'x'));
+}
+
+CU_TEST(CompiledMatchesRuntime)
+{
+    CU_EXPECT_EQ(CU::Format(CU_FMT("cpu{}: busy={}ns idle={}ns"), 7, UINT64_MAX, -5),
+        CU::Format("cpu{}: busy={}ns idle={}ns", 7, UINT64_MAX, -5));
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{:0}x{2}{}"), "abc", 1, 2), CU::Format("{:0}x{2}{}", "abc", 1, 2));
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}%"), -0.125), CU::Format("{}%", -0.125));
+}
+
+CU_TEST(FormatToBuffer)
+{
+    char buffer[32];
+    CU_EXPECT_EQ(CU::FormatTo(buffer, sizeof(buffer), CU_FMT("/sys/kernel/tracing/events/{}/id"), "a/b"), 33U);
+    CU_EXPECT_EQ(std::string(buffer), "/sys/kernel/tracing/events/a/b/");
+    CU_EXPECT_EQ(CU::FormatTo(buffer, sizeof(buffer), CU_FMT("cpu{}:{}"), 3, std::string("x")), 6U);
+    CU_EXPECT_EQ(std::string(buffer), "cpu3:x");
+
+    char small[4] = {'z', 'z', 'z', 'z'};
+    CU_EXPECT_EQ(CU::FormatTo(small, sizeof(small), CU_FMT("{}"), 123456), 6U);
+    CU_EXPECT_EQ(std::string(small), "123");
+    CU_EXPECT_EQ(CU::FormatTo(small, 1, CU_FMT("{}"), 1), 1U);
+    CU_EXPECT_EQ(small[0], '\0');
+    CU_EXPECT_EQ(CU::FormatTo(small, 0, CU_FMT("{}"), 1), 1U);
+    CU_EXPECT_EQ(CU::FormatTo(nullptr, 0, CU_FMT("{}{}"), "ab", 'c'), 3U);
+}
+
+CU_TEST(FormatToIterator)
+{
+    std::string content("prefix:");
+    CU::FormatTo(std::back_inserter(content), CU_FMT("{}/{}"), "map", 42);
+    CU_EXPECT_EQ(content, "prefix:map/42");
+
+    std::vector<char> chars{};
+    auto iter = CU::FormatTo(std::back_inserter(chars), CU_FMT("{:2}"), "abc");
+    *iter = '!';
+    CU_EXPECT_EQ(std::string(chars.begin(), chars.end()), "ab!");
+}
+
+CU_TEST(FormatTemp)
+{
+    const auto &first = CU::FormatTemp(CU_FMT("{}-{}"), 1, 2);
+    CU_EXPECT_EQ(first, "1-2");
+    auto data = first.data();
+    const auto &second = CU::FormatTemp(CU_FMT("{}"), "ab");
+    CU_EXPECT_EQ(second, "ab");
+    CU_EXPECT(std::addressof(first) == std::addressof(second));
+    CU_EXPECT(second.data() == data);
+}
+
+CU_TEST(IntegersMatchToString)
+{
+    uint64_t state = 88172645463325252ULL;
+    for (int idx = 0; idx < 100000; idx++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Spread the values over every digit count.
+        auto value = state >> (state % 64);
+        auto signedValue = static_cast<int64_t>(state) >> (state % 63);
+        CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), value), std::to_string(value));
+        CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), signedValue), std::to_string(signedValue));
+        CU_EXPECT_EQ(CU::Format("{}", static_cast<int32_t>(signedValue)), std::to_string(static_cast<int32_t>(signedValue)));
+    }
+    for (uint64_t power = 1; power < UINT64_MAX / 10; power *= 10) {
+        CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), power - 1), std::to_string(power - 1));
+        CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), power), std::to_string(power));
+    }
+}
+
+CU_TEST(FloatsRoundTrip)
+{
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), 0.1), "0.1");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), 0.1f), "0.1");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), 1e300), "1e+300");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), 123456789.0), "123456789.0");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{} {}"), std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()), "inf -inf");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), std::numeric_limits<double>::quiet_NaN()), "nan");
+
+    uint64_t state = 2463534242ULL;
+    for (int idx = 0; idx < 100000; idx++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double value = 0;
+        std::memcpy(std::addressof(value), std::addressof(state), sizeof(value));
+        if (!std::isfinite(value)) {
+            continue;
+        }
+        auto str = CU::Format(CU_FMT("{}"), value);
+        CU_EXPECT(std::strtod(str.c_str(), nullptr) == value);
+        auto floatValue = static_cast<float>(static_cast<double>(state % 1000000) / 1000);
+        CU_EXPECT(std::strtof(CU::Format("{}", floatValue).c_str(), nullptr) == floatValue);
+    }
+}
+
+CU_TEST(HexAndPointers)
+{
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), CU::Hex(0)), "0");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), CU::Hex(0xff)), "ff");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("0x{}"), CU::Hex(UINT64_MAX)), "0xffffffffffffffff");
+    CU_EXPECT_EQ(CU::Format("{}", CU::Hex(-1)), "ffffffff");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), CU::Hex(static_cast<int8_t>(-2))), "fe");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), CU::Hex(0x3a, 8)), "0000003a");
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), CU::Hex(0x123456, 2)), "123456");
+    auto ptr = reinterpret_cast<const int*>(0x7ffd1234);
+    CU_EXPECT_EQ(CU::Format(CU_FMT("{}"), ptr), "0x7ffd1234");
+    CU_EXPECT_EQ(CU::Format("{}", ptr), "0x7ffd1234");
+}
+
+CU_TEST_MAIN()
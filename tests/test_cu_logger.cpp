@@ -0,0 +1,120 @@
+#include "cu_test.h"
+#include "CuLogger.h"
+#include "libcu.h"
+#include <unistd.h>
+
+namespace
+{
+    std::vector<std::string> ReadLines(const std::string &path)
+    {
+        std::vector<std::string> lines{};
+        auto fp = std::fopen(path.c_str(), "rt");
+        if (fp == nullptr) {
+            return lines;
+        }
+        char buffer[512];
+        while (std::fgets(buffer, sizeof(buffer), fp) != nullptr) {
+            lines.emplace_back(buffer);
+        }
+        std::fclose(fp);
+        return lines;
+    }
+
+    // "MM-DD hh:mm:ss [L] " followed by the message.
+    bool HasPrefix(const std::string &line, char level)
+    {
+        static constexpr char pattern[] = "00-00 00:00:00 [L] ";
+        if (line.size() < (sizeof(pattern) - 1)) {
+            return false;
+        }
+        for (size_t pos = 0; pos < (sizeof(pattern) - 1); pos++) {
+            bool matched = (pattern[pos] == '0') ? (line[pos] >= '0' && line[pos] <= '9') :
+                ((pattern[pos] == 'L') ? (line[pos] == level) : (line[pos] == pattern[pos]));
+            if (!matched) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string logPath{};
+}
+
+// The logger is a process wide singleton, one small queue serves every test below in order.
+CU_TEST(LevelsAndFormats)
+{
+    char pathTemplate[] = "/tmp/test_cu_logger_XXXXXX";
+    int fd = mkstemp(pathTemplate);
+    CU_EXPECT(fd >= 0);
+    close(fd);
+    logPath = pathTemplate;
+
+    CU::Logger::Info("filtered before Create");
+    CU::Logger::Create(CU::Logger::LogLevel::DEBUG, logPath, 4096);
+    CU::Logger::Error(CU_FMT("error {}"), 1);
+    CU::Logger::Warn("warn {}", 2);
+    CU::Logger::Info(CU_FMT("info {} {}"), "a", std::string("b"));
+    CU::Logger::Debug("debug");
+    CU::Logger::Verbose(CU_FMT("verbose is filtered {}"), 5);
+    CU::Logger::Flush();
+
+    auto lines = ReadLines(logPath);
+    CU_EXPECT_EQ(lines.size(), 4U);
+    if (lines.size() == 4) {
+        CU_EXPECT(HasPrefix(lines[0], 'E') && lines[0].substr(19) == "error 1\n");
+        CU_EXPECT(HasPrefix(lines[1], 'W') && lines[1].substr(19) == "warn 2\n");
+        CU_EXPECT(HasPrefix(lines[2], 'I') && lines[2].substr(19) == "info a b\n");
+        CU_EXPECT(HasPrefix(lines[3], 'D') && lines[3].substr(19) == "debug\n");
+    }
+}
+
+CU_TEST(ConcurrentProducersAndDrops)
+{
+    static constexpr int threadCount = 4;
+    static constexpr int linesPerThread = 5000;
+
+    auto droppedBefore = CU::Logger::DroppedLines();
+    std::vector<std::thread> threads{};
+    for (int thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([thread]() {
+            for (int line = 0; line < linesPerThread; line++) {
+                CU::Logger::Info(CU_FMT("thread {} line {}"), thread, line);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CU::Logger::Flush();
+    auto dropped = CU::Logger::DroppedLines() - droppedBefore;
+    // The next write reports the drops.
+    CU::Logger::Info(CU_FMT("done"));
+    CU::Logger::Flush();
+
+    auto lines = ReadLines(logPath);
+    std::vector<int> nextLine(threadCount, 0);
+    uint64_t written = 0;
+    uint64_t reportedDrops = 0;
+    bool ordered = true;
+    for (const auto &line : lines) {
+        int thread = 0;
+        int lineIdx = 0;
+        uint64_t droppedCount = 0;
+        if (std::sscanf(line.c_str() + 19, "thread %d line %d", &thread, &lineIdx) == 2) {
+            // Lines of one thread keep their order, some may be missing.
+            ordered = ordered && (lineIdx >= nextLine[thread]);
+            nextLine[thread] = lineIdx + 1;
+            written++;
+        } else if (std::sscanf(line.c_str() + 19, "%llu log lines dropped", reinterpret_cast<unsigned long long*>(&droppedCount)) == 1) {
+            CU_EXPECT(HasPrefix(line, 'W'));
+            reportedDrops += droppedCount;
+        }
+    }
+    CU_EXPECT(ordered);
+    CU_EXPECT_EQ(written + dropped, static_cast<uint64_t>(threadCount * linesPerThread));
+    CU_EXPECT_EQ(reportedDrops, CU::Logger::DroppedLines());
+    CU_EXPECT(lines.size() > 0 && lines.back().substr(19) == "done\n");
+    unlink(logPath.c_str());
+}
+
+CU_TEST_MAIN()
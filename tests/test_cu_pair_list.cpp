@@ -0,0 +1,82 @@
+#include "cu_test.h"
+#include "CuPairList.h"
+
+typedef CU::PairList<int, std::string> MapList;
+
+CU_TEST(AddAndLookup)
+{
+    MapList maps{};
+    maps.add(3, "cpu_util_map");
+    maps.add(CU::PairList<int, std::string>::Pair(4, "last_ts_map"));
+    CU_EXPECT_EQ(maps.size(), 2U);
+    CU_EXPECT_EQ(maps.atKey(3), "cpu_util_map");
+    CU_EXPECT_EQ(maps.atValue("last_ts_map"), 4);
+    CU_EXPECT(maps.containsKey(4));
+    CU_EXPECT(!maps.containsKey(5));
+    CU_EXPECT(maps.containsValue("cpu_util_map"));
+    CU_EXPECT(!maps.containsValue("missing"));
+    CU_EXPECT_EQ(maps.keys(), (std::vector<int>{3, 4}));
+    CU_EXPECT_EQ(maps.values(), (std::vector<std::string>{"cpu_util_map", "last_ts_map"}));
+}
+
+CU_TEST(MissingLookupThrows)
+{
+    MapList maps{};
+    CU_EXPECT_THROW(maps.atKey(1), CU::PairListExcept);
+    maps.add(1, "a");
+    CU_EXPECT_THROW(maps.atValue("b"), CU::PairListExcept);
+}
+
+CU_TEST(SubscriptInserts)
+{
+    MapList maps{};
+    maps[7] = "seven";
+    maps[7] += "!";
+    CU_EXPECT_EQ(maps.size(), 1U);
+    CU_EXPECT_EQ(maps.atKey(7), "seven!");
+    maps("eight") = 8;
+    CU_EXPECT_EQ(maps.atValue("eight"), 8);
+    CU_EXPECT_EQ(maps.size(), 2U);
+}
+
+CU_TEST(FindAndRemove)
+{
+    MapList maps{};
+    maps.add(1, "a");
+    maps.add(2, "b");
+    maps.add(3, "c");
+    maps.add(2, "d");
+    CU_EXPECT(maps.findKey(2)->value() == "b");
+    CU_EXPECT(maps.findValue("z") == maps.end());
+
+    maps.removeKey(2);
+    CU_EXPECT_EQ(maps.atKey(2), "d");
+    maps.removeValue("a");
+    CU_EXPECT(!maps.containsKey(1));
+    maps.remove(maps.findKey(3));
+    CU_EXPECT_EQ(maps.size(), 1U);
+    maps.clear();
+    CU_EXPECT_EQ(maps.size(), 0U);
+}
+
+CU_TEST(SortReverseAndCompare)
+{
+    MapList maps{};
+    maps.add(3, "c");
+    maps.add(1, "a");
+    maps.add(2, "b");
+    maps.sort();
+    CU_EXPECT_EQ(maps.keys(), (std::vector<int>{1, 2, 3}));
+    maps.reverse();
+    CU_EXPECT_EQ(maps.front().key(), 3);
+    CU_EXPECT_EQ(maps.back().key(), 1);
+
+    MapList copy(maps);
+    CU_EXPECT(copy == maps);
+    copy[1] = "x";
+    CU_EXPECT(copy != maps);
+    MapList moved(std::move(copy));
+    CU_EXPECT_EQ(moved.atKey(1), "x");
+}
+
+CU_TEST_MAIN()
@@ -0,0 +1,330 @@
+#include "cu_test.h"
+#include "cu_util_account.h"
+
+CU_TEST(SchedSwitchChargesPrevTask)
+{
+    cu_util_config config{};
+    uint64_t lastTs = 1000;
+    uint64_t idleTotal = 0;
+    uint64_t busyTotal = 0;
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 0, 1500, 0, &lastTs, &idleTotal, &busyTotal), 500U);
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 0, 1800, 42, &lastTs, &idleTotal, &busyTotal), 300U);
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 0, 1800, 42, &lastTs, &idleTotal, &busyTotal), 0U);
+    CU_EXPECT_EQ(idleTotal, 500U);
+    CU_EXPECT_EQ(busyTotal, 300U);
+    CU_EXPECT_EQ(lastTs, 1800U);
+
+    config.ignored_cpu_mask = (1ULL << 1);
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 1, 2000, 42, &lastTs, &idleTotal, &busyTotal), 0U);
+    CU_EXPECT_EQ(busyTotal, 300U);
+    CU_EXPECT_EQ(lastTs, 2000U);
+    cu_util_account_sched_switch(&config, 0, 2100, 42, &lastTs, nullptr, nullptr);
+    CU_EXPECT_EQ(lastTs, 2100U);
+}
+
+CU_TEST(SchedSwitchSkipsFirstAndIgnoredGaps)
+{
+    cu_util_config config{};
+    uint64_t lastTs = 0;
+    uint64_t idleTotal = 0;
+    uint64_t busyTotal = 0;
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 0, 5000000000ULL, 42, &lastTs, &idleTotal, &busyTotal), 0U);
+    CU_EXPECT_EQ(busyTotal, 0U);
+    CU_EXPECT_EQ(lastTs, 5000000000ULL);
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 0, 5000000100ULL, 42, &lastTs, &idleTotal, &busyTotal), 100U);
+
+    // A cpu monitored again only charges the time since its last switch.
+    config.ignored_cpu_mask = 1ULL;
+    cu_util_account_sched_switch(&config, 0, 9000000000ULL, 42, &lastTs, &idleTotal, &busyTotal);
+    config.ignored_cpu_mask = 0;
+    CU_EXPECT_EQ(cu_util_account_sched_switch(&config, 0, 9000000200ULL, 0, &lastTs, &idleTotal, &busyTotal), 200U);
+    CU_EXPECT_EQ(busyTotal, 100U);
+    CU_EXPECT_EQ(idleTotal, 200U);
+}
+
+CU_TEST(CpuClockCapsMissedSamples)
+{
+    cu_util_config config{};
+    config.flags = CU_UTIL_FLAG_SAMPLED_ACCOUNTING;
+    config.sample_period_ns = 100;
+    uint64_t lastTs = 0;
+    uint64_t idleTotal = 0;
+    uint64_t busyTotal = 0;
+    cu_util_account_cpu_clock(&config, 0, 1000, 7, &lastTs, &idleTotal, &busyTotal);
+    CU_EXPECT_EQ(busyTotal, 0U);
+    CU_EXPECT_EQ(cu_util_account_cpu_clock(&config, 0, 1100, 7, &lastTs, &idleTotal, &busyTotal), 100U);
+    cu_util_account_cpu_clock(&config, 0, 1200, 0, &lastTs, &idleTotal, &busyTotal);
+    CU_EXPECT_EQ(cu_util_account_cpu_clock(&config, 0, 5000, 0, &lastTs, &idleTotal, &busyTotal), 100U);
+    CU_EXPECT_EQ(busyTotal, 100U);
+    CU_EXPECT_EQ(idleTotal, 200U);
+
+    // Exact sched_switch accounting is off in sampled mode.
+    cu_util_account_sched_switch(&config, 0, 6000, 7, &lastTs, &idleTotal, &busyTotal);
+    CU_EXPECT_EQ(busyTotal, 100U);
+}
+
+CU_TEST(CpuIdleResidencyPerState)
+{
+    cu_util_config config{};
+    cu_util_idle_stats stats{};
+    cu_util_account_cpu_idle(&config, 0, 1000, 0, &stats);
+    cu_util_account_cpu_idle(&config, 0, 1250, CU_UTIL_IDLE_STATE_EXIT, &stats);
+    cu_util_account_cpu_idle(&config, 0, 2000, 2, &stats);
+    cu_util_account_cpu_idle(&config, 0, 9000, CU_UTIL_IDLE_STATE_EXIT, &stats);
+    cu_util_account_cpu_idle(&config, 0, 9500, 2, &stats);
+    CU_EXPECT_EQ(stats.residency_ns[0], 250U);
+    CU_EXPECT_EQ(stats.entry_count[0], 1U);
+    CU_EXPECT_EQ(stats.residency_ns[2], 7000U);
+    CU_EXPECT_EQ(stats.entry_count[2], 2U);
+    CU_EXPECT_EQ(stats.entry_ts, 9500U);
+
+    // An exit without a tracked entry (attached mid idle period) charges nothing.
+    cu_util_idle_stats midStats{};
+    cu_util_account_cpu_idle(&config, 0, 3000, CU_UTIL_IDLE_STATE_EXIT, &midStats);
+    CU_EXPECT_EQ(midStats.residency_ns[0], 0U);
+
+    // Out of range states are tracked as idle periods but not charged.
+    cu_util_account_cpu_idle(&config, 0, 4000, CU_UTIL_MAX_IDLE_STATES, &midStats);
+    cu_util_account_cpu_idle(&config, 0, 5000, CU_UTIL_IDLE_STATE_EXIT, &midStats);
+    uint64_t residencyTotal = 0;
+    for (const auto &residency : midStats.residency_ns) {
+        residencyTotal += residency;
+    }
+    CU_EXPECT_EQ(residencyTotal, 0U);
+    CU_EXPECT_EQ(midStats.entry_ts, 0U);
+
+    config.ignored_cpu_mask = 1;
+    cu_util_account_cpu_idle(&config, 0, 10000, 1, &midStats);
+    CU_EXPECT_EQ(midStats.entry_count[1], 0U);
+}
+
+CU_TEST(IrqTimeExcludesNestedHardirqs)
+{
+    cu_util_config config{};
+    cu_util_irq_stats stats{};
+    // A softirq on a busy task, interrupted by a hardirq.
+    cu_util_account_softirq(&config, 0, 1000, 42, 3, 0, &stats);
+    cu_util_account_hardirq(&config, 0, 1200, 42, 0, &stats);
+    cu_util_account_hardirq(&config, 0, 1300, 42, 1, &stats);
+    cu_util_account_softirq(&config, 0, 1600, 42, 3, 1, &stats);
+    CU_EXPECT_EQ(stats.hardirq_ns, 100U);
+    CU_EXPECT_EQ(stats.hardirq_count, 1U);
+    CU_EXPECT_EQ(stats.softirq_ns[3], 500U);
+    CU_EXPECT_EQ(stats.softirq_count[3], 1U);
+    CU_EXPECT_EQ(stats.idle_irq_ns, 0U);
+
+    // Interrupts of the idle task.
+    cu_util_account_hardirq(&config, 0, 2000, 0, 0, &stats);
+    cu_util_account_hardirq(&config, 0, 2050, 0, 1, &stats);
+    cu_util_account_softirq(&config, 0, 2050, 0, 1, 0, &stats);
+    cu_util_account_softirq(&config, 0, 2250, 0, 1, 1, &stats);
+    CU_EXPECT_EQ(stats.hardirq_ns, 150U);
+    CU_EXPECT_EQ(stats.softirq_ns[1], 200U);
+    CU_EXPECT_EQ(stats.idle_irq_ns, 250U);
+
+    // Exits without a matching entry and out of range vectors are not charged.
+    cu_util_account_hardirq(&config, 0, 3000, 42, 1, &stats);
+    cu_util_account_softirq(&config, 0, 3000, 42, 2, 0, &stats);
+    cu_util_account_softirq(&config, 0, 3100, 42, 4, 1, &stats);
+    cu_util_account_softirq(&config, 0, 3200, 42, CU_UTIL_MAX_SOFTIRQS, 0, &stats);
+    cu_util_account_softirq(&config, 0, 3300, 42, CU_UTIL_MAX_SOFTIRQS, 1, &stats);
+    CU_EXPECT_EQ(stats.hardirq_count, 2U);
+    CU_EXPECT_EQ(stats.softirq_ns[2] + stats.softirq_ns[4], 0U);
+    CU_EXPECT_EQ(stats.softirq_entry_ts, 0U);
+}
+
+CU_TEST(SwitchCountsSplitByPrevState)
+{
+    cu_util_config config{};
+    cu_util_switch_counts counts{};
+    cu_util_account_switch_count(&config, 0, 42, 0, &counts);
+    cu_util_account_switch_count(&config, 0, 42, 0x100, &counts);
+    cu_util_account_switch_count(&config, 0, 42, 1, &counts);
+    cu_util_account_switch_count(&config, 0, 42, 2, &counts);
+    CU_EXPECT_EQ(counts.involuntary, 2U);
+    CU_EXPECT_EQ(counts.voluntary, 2U);
+
+    cu_util_account_switch_count(&config, 0, 0, 0, &counts);
+    config.ignored_cpu_mask = (1ULL << 1);
+    cu_util_account_switch_count(&config, 1, 42, 0, &counts);
+    cu_util_account_switch_count(&config, 0, 42, 0, nullptr);
+    CU_EXPECT_EQ(counts.involuntary, 2U);
+    CU_EXPECT_EQ(counts.voluntary, 2U);
+}
+
+CU_TEST(MigrationMatrixSkipsIgnoredPairs)
+{
+    cu_util_config config{};
+    cu_util_migration_stats stats{};
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 0, 4, &stats), 1);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 0, 4, &stats), 1);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 4, 0, &stats), 1);
+    CU_EXPECT_EQ(stats.count[0][4], 2U);
+    CU_EXPECT_EQ(stats.count[4][0], 1U);
+
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 3, 3, &stats), 0);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, -1, 3, &stats), 0);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 0, CU_UTIL_MAX_CPUS, &stats), 0);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 0, 1, nullptr), 0);
+
+    config.ignored_cpu_mask = (1ULL << 1) | (1ULL << 2);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 1, 2, &stats), 0);
+    CU_EXPECT_EQ(cu_util_account_migration(&config, 1, 0, &stats), 1);
+    CU_EXPECT_EQ(stats.count[1][2], 0U);
+    CU_EXPECT_EQ(stats.count[1][0], 1U);
+}
+
+CU_TEST(WakeupCountsSplitLocalAndRemote)
+{
+    cu_util_config config{};
+    cu_util_wakeup_counts counts{};
+    CU_EXPECT_EQ(cu_util_account_wakeup(&config, 2, 2, &counts), 1);
+    CU_EXPECT_EQ(cu_util_account_wakeup(&config, 2, 5, &counts), 1);
+    CU_EXPECT_EQ(cu_util_account_wakeup(&config, 2, 6, &counts), 1);
+    CU_EXPECT_EQ(counts.local, 1U);
+    CU_EXPECT_EQ(counts.remote, 2U);
+
+    config.ignored_cpu_mask = (1ULL << 2);
+    CU_EXPECT_EQ(cu_util_account_wakeup(&config, 2, 5, &counts), 0);
+    CU_EXPECT_EQ(cu_util_account_wakeup(&config, 3, 3, nullptr), 0);
+    CU_EXPECT_EQ(counts.remote, 2U);
+    CU_EXPECT_EQ(cu_util_is_wakeup_pairs(&config), 0);
+    config.flags = CU_UTIL_FLAG_WAKEUP_PAIRS;
+    CU_EXPECT_EQ(cu_util_is_wakeup_pairs(&config), 1);
+}
+
+CU_TEST(ClassBusySplitsByPrio)
+{
+    CU_EXPECT_EQ(cu_util_prio_class(-1), static_cast<uint32_t>(CU_UTIL_PRIO_CLASS_RT));
+    CU_EXPECT_EQ(cu_util_prio_class(99), static_cast<uint32_t>(CU_UTIL_PRIO_CLASS_RT));
+    CU_EXPECT_EQ(cu_util_prio_class(100), static_cast<uint32_t>(CU_UTIL_PRIO_CLASS_NORMAL));
+    CU_EXPECT_EQ(cu_util_prio_class(129), static_cast<uint32_t>(CU_UTIL_PRIO_CLASS_NORMAL));
+    CU_EXPECT_EQ(cu_util_prio_class(130), static_cast<uint32_t>(CU_UTIL_PRIO_CLASS_BACKGROUND));
+    CU_EXPECT_EQ(cu_util_prio_class(139), static_cast<uint32_t>(CU_UTIL_PRIO_CLASS_BACKGROUND));
+
+    cu_util_class_busy classBusy{};
+    cu_util_account_class_busy(100, 42, 98, &classBusy);
+    cu_util_account_class_busy(200, 42, 120, &classBusy);
+    cu_util_account_class_busy(300, 42, 130, &classBusy);
+    cu_util_account_class_busy(400, 0, 120, &classBusy);
+    cu_util_account_class_busy(0, 42, 120, &classBusy);
+    cu_util_account_class_busy(500, 42, 120, nullptr);
+    CU_EXPECT_EQ(classBusy.busy_ns[CU_UTIL_PRIO_CLASS_RT], 100U);
+    CU_EXPECT_EQ(classBusy.busy_ns[CU_UTIL_PRIO_CLASS_NORMAL], 200U);
+    CU_EXPECT_EQ(classBusy.busy_ns[CU_UTIL_PRIO_CLASS_BACKGROUND], 300U);
+}
+
+CU_TEST(SliceHistogramLog2Buckets)
+{
+    CU_EXPECT_EQ(cu_util_log2(0), 0U);
+    CU_EXPECT_EQ(cu_util_log2(1), 0U);
+    CU_EXPECT_EQ(cu_util_log2(3), 1U);
+    CU_EXPECT_EQ(cu_util_log2(4), 2U);
+    CU_EXPECT_EQ(cu_util_log2(0xffffU), 15U);
+    CU_EXPECT_EQ(cu_util_log2(0x10000U), 16U);
+    CU_EXPECT_EQ(cu_util_log2(1ULL << 40), 40U);
+    CU_EXPECT_EQ(cu_util_log2(UINT64_MAX), 63U);
+
+    CU_EXPECT_EQ(cu_util_slice_bucket(1999), 0U);
+    CU_EXPECT_EQ(cu_util_slice_bucket(2000), 1U);
+    CU_EXPECT_EQ(cu_util_slice_bucket(4000000), 11U);
+    CU_EXPECT_EQ(cu_util_slice_bucket(UINT64_MAX), static_cast<uint32_t>(CU_UTIL_SLICE_HIST_BUCKETS - 1));
+
+    cu_util_slice_hist sliceHist{};
+    cu_util_account_slice(4000000, 42, 120, &sliceHist);
+    cu_util_account_slice(4000000, 42, 50, &sliceHist);
+    cu_util_account_slice(4000000, 0, 120, &sliceHist);
+    cu_util_account_slice(0, 42, 120, &sliceHist);
+    CU_EXPECT_EQ(sliceHist.count[CU_UTIL_PRIO_CLASS_NORMAL][11], 1U);
+    CU_EXPECT_EQ(sliceHist.count[CU_UTIL_PRIO_CLASS_RT][11], 1U);
+    CU_EXPECT_EQ(sliceHist.count[CU_UTIL_PRIO_CLASS_NORMAL][0], 0U);
+
+    // The first switch on a cpu is no slice, it would land in the last bucket.
+    cu_util_config config{};
+    uint64_t lastTs = 0;
+    cu_util_account_slice(cu_util_account_sched_switch(&config, 0, 5000000000ULL, 42, &lastTs, nullptr, nullptr), 42, 120, &sliceHist);
+    CU_EXPECT_EQ(sliceHist.count[CU_UTIL_PRIO_CLASS_NORMAL][CU_UTIL_SLICE_HIST_BUCKETS - 1], 0U);
+    cu_util_account_slice(cu_util_account_sched_switch(&config, 0, 5004000000ULL, 42, &lastTs, nullptr, nullptr), 42, 120, &sliceHist);
+    CU_EXPECT_EQ(sliceHist.count[CU_UTIL_PRIO_CLASS_NORMAL][11], 2U);
+}
+
+CU_TEST(OffCpuTimeChargedToSwitchOutState)
+{
+    CU_EXPECT_EQ(cu_util_offcpu_state(0), static_cast<uint32_t>(CU_UTIL_OFFCPU_RUNNABLE));
+    CU_EXPECT_EQ(cu_util_offcpu_state(0x100), static_cast<uint32_t>(CU_UTIL_OFFCPU_RUNNABLE));
+    CU_EXPECT_EQ(cu_util_offcpu_state(0x1), static_cast<uint32_t>(CU_UTIL_OFFCPU_INTERRUPTIBLE));
+    CU_EXPECT_EQ(cu_util_offcpu_state(0x2), static_cast<uint32_t>(CU_UTIL_OFFCPU_UNINTERRUPTIBLE));
+    CU_EXPECT_EQ(cu_util_offcpu_state(0x4), static_cast<uint32_t>(CU_UTIL_OFFCPU_OTHER));
+
+    cu_util_config config{};
+    cu_util_task_offcpu offcpu{};
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 1000, &offcpu), 0U);
+    cu_util_account_switch_out(&config, 0, 1000, 0x2, &offcpu);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 1600, &offcpu), 600U);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 1700, &offcpu), 0U);
+    cu_util_account_switch_out(&config, 0, 2000, 0, &offcpu);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 2050, &offcpu), 50U);
+    cu_util_account_switch_out(&config, 0, 3000, 0x1, &offcpu);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 2500, &offcpu), 0U);
+    CU_EXPECT_EQ(offcpu.switch_out_ts, 0U);
+
+    CU_EXPECT_EQ(offcpu.off_cpu_ns[CU_UTIL_OFFCPU_UNINTERRUPTIBLE], 600U);
+    CU_EXPECT_EQ(offcpu.off_cpu_ns[CU_UTIL_OFFCPU_RUNNABLE], 50U);
+    CU_EXPECT_EQ(offcpu.off_cpu_ns[CU_UTIL_OFFCPU_INTERRUPTIBLE], 0U);
+    CU_EXPECT_EQ(offcpu.off_cpu_count[CU_UTIL_OFFCPU_UNINTERRUPTIBLE], 1U);
+    CU_EXPECT_EQ(offcpu.off_cpu_count[CU_UTIL_OFFCPU_RUNNABLE], 1U);
+}
+
+CU_TEST(ExitedTaskFoldsIntoAggregate)
+{
+    CU_EXPECT_EQ(cu_util_is_task_exited(0x10), 1);
+    CU_EXPECT_EQ(cu_util_is_task_exited(0x20), 1);
+    CU_EXPECT_EQ(cu_util_is_task_exited(0x2), 0);
+    CU_EXPECT_EQ(cu_util_is_task_exited(0), 0);
+
+    cu_util_task_stats taskStats{};
+    taskStats.switches.voluntary = 3;
+    taskStats.switches.involuntary = 2;
+    taskStats.migrations = 1;
+    cu_util_task_offcpu offcpu{};
+    offcpu.off_cpu_ns[CU_UTIL_OFFCPU_UNINTERRUPTIBLE] = 500;
+    offcpu.off_cpu_ns[CU_UTIL_OFFCPU_OTHER] = 7;
+
+    cu_util_exited_stats exitedStats{};
+    cu_util_fold_exited_task(&taskStats, &offcpu, 1, &exitedStats);
+    cu_util_fold_exited_task(&taskStats, nullptr, 1, &exitedStats);
+    cu_util_fold_exited_task(nullptr, &offcpu, 0, &exitedStats);
+    cu_util_fold_exited_task(nullptr, nullptr, 0, &exitedStats);
+    cu_util_fold_exited_task(&taskStats, &offcpu, 1, nullptr);
+    CU_EXPECT_EQ(exitedStats.task_count, 2U);
+    cu_util_fold_exited_task(nullptr, nullptr, 1, &exitedStats);
+    CU_EXPECT_EQ(exitedStats.task_count, 3U);
+    CU_EXPECT_EQ(exitedStats.switches.voluntary, 6U);
+    CU_EXPECT_EQ(exitedStats.switches.involuntary, 4U);
+    CU_EXPECT_EQ(exitedStats.migrations, 2U);
+    CU_EXPECT_EQ(exitedStats.off_cpu_ns[CU_UTIL_OFFCPU_UNINTERRUPTIBLE], 1000U);
+    CU_EXPECT_EQ(exitedStats.off_cpu_ns[CU_UTIL_OFFCPU_OTHER], 14U);
+    CU_EXPECT_EQ(exitedStats.off_cpu_ns[CU_UTIL_OFFCPU_RUNNABLE], 0U);
+}
+
+CU_TEST(OffCpuSkipsTimeOnIgnoredCpus)
+{
+    cu_util_config config{};
+    config.ignored_cpu_mask = (1ULL << 5);
+    cu_util_task_offcpu offcpu{};
+
+    // Switched out on cpu0, runs on the ignored cpu5, comes back to cpu0.
+    cu_util_account_switch_out(&config, 0, 1000, 0x1, &offcpu);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 5, 1500, &offcpu), 0U);
+    CU_EXPECT_EQ(offcpu.switch_out_ts, 0U);
+    cu_util_account_switch_out(&config, 5, 4000, 0x1, &offcpu);
+    CU_EXPECT_EQ(offcpu.switch_out_ts, 0U);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 9000, &offcpu), 0U);
+
+    cu_util_account_switch_out(&config, 0, 10000, 0x1, &offcpu);
+    CU_EXPECT_EQ(cu_util_account_switch_in(&config, 0, 10300, &offcpu), 300U);
+    CU_EXPECT_EQ(offcpu.off_cpu_ns[CU_UTIL_OFFCPU_INTERRUPTIBLE], 300U);
+    CU_EXPECT_EQ(offcpu.off_cpu_count[CU_UTIL_OFFCPU_INTERRUPTIBLE], 1U);
+}
+
+CU_TEST_MAIN()
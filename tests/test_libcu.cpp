@@ -0,0 +1,139 @@
+#include "cu_test.h"
+#include "libcu.h"
+
+typedef std::vector<std::string> StrList;
+
+CU_TEST(StrSplitByString)
+{
+    CU_EXPECT_EQ(CU::StrSplit(std::string("a::b::c"), std::string("::")), (StrList{"a", "b", "c"}));
+    CU_EXPECT_EQ(CU::StrSplit(std::string("::a::::b::"), std::string("::")), (StrList{"a", "b"}));
+    CU_EXPECT_EQ(CU::StrSplit(std::string("a, b"), ", "), (StrList{"a", "b"}));
+    CU_EXPECT_EQ(CU::StrSplit(std::string("abc"), ""), StrList{});
+    CU_EXPECT_EQ(CU::StrSplit(std::string("::"), "::"), StrList{});
+    CU_EXPECT_EQ(CU::StrSplit(std::string("ab"), "::"), StrList{"ab"});
+    CU_EXPECT_EQ(CU::StrSplit(std::string("a"), std::string("::")), StrList{"a"});
+}
+
+CU_TEST(StrSplitByChar)
+{
+    CU_EXPECT_EQ(CU::StrSplit(std::string("5.10.66"), '.'), (StrList{"5", "10", "66"}));
+    CU_EXPECT_EQ(CU::StrSplit(std::string("ab,cd"), ','), (StrList{"ab", "cd"}));
+    CU_EXPECT_EQ(CU::StrSplit(std::string(",a,,b,"), ','), (StrList{"a", "b"}));
+    CU_EXPECT_EQ(CU::StrSplit(std::string("abc"), ','), StrList{"abc"});
+    CU_EXPECT_EQ(CU::StrSplit(std::string("a"), ','), StrList{"a"});
+    CU_EXPECT_EQ(CU::StrSplit(std::string(","), ','), StrList{});
+    CU_EXPECT_EQ(CU::StrSplit(std::string(""), ','), StrList{});
+}
+
+CU_TEST(StrSplitAt)
+{
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("cpu0 12 34"), ' ', 0), "cpu0");
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("cpu0 12 34"), ' ', 2), "34");
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("cpu0 12 34"), ' ', 3), "");
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("a--b--c"), "--", 1), "b");
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("a--b--c"), std::string("--"), 2), "c");
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("7"), ' ', 0), "7");
+    CU_EXPECT_EQ(CU::StrSplitAt(std::string("7"), "--", 0), "7");
+}
+
+CU_TEST(SubPrevStr)
+{
+    CU_EXPECT_EQ(CU::SubPrevStr(std::string("CuUtilMonitor.o"), ".o"), "CuUtilMonitor");
+    CU_EXPECT_EQ(CU::SubPrevStr(std::string("5.10.66-android"), '-'), "5.10.66");
+    CU_EXPECT_EQ(CU::SubPrevStr(std::string("no-delimiter"), ':'), "no-delimiter");
+    CU_EXPECT_EQ(CU::SubPrevStr(std::string("a/b/c"), std::string("/")), "a");
+}
+
+CU_TEST(SubRePrevStr)
+{
+    CU_EXPECT_EQ(CU::SubRePrevStr(std::string("a/b/c"), '/'), "a/b");
+    CU_EXPECT_EQ(CU::SubRePrevStr(std::string("a/b/c"), "/"), "a/b");
+    CU_EXPECT_EQ(CU::SubRePrevStr(std::string("abc"), '/'), "abc");
+    CU_EXPECT_EQ(CU::SubRePrevStr(std::string("/abc"), '/'), "");
+}
+
+CU_TEST(SubPostStr)
+{
+    CU_EXPECT_EQ(CU::SubPostStr(std::string("bpf_map_cpu_util"), "bpf_map_"), "cpu_util");
+    CU_EXPECT_EQ(CU::SubPostStr(std::string("key=value=x"), '='), "value=x");
+    CU_EXPECT_EQ(CU::SubPostStr(std::string("key"), '='), "");
+    CU_EXPECT_EQ(CU::SubPostStr(std::string("key"), std::string("missing")), "");
+}
+
+CU_TEST(SubRePostStr)
+{
+    CU_EXPECT_EQ(CU::SubRePostStr(std::string("/data/CuUtilMonitor.o"), '/'), "CuUtilMonitor.o");
+    CU_EXPECT_EQ(CU::SubRePostStr(std::string("CuUtilMonitor.o"), '/'), "");
+    CU_EXPECT_EQ(CU::SubRePostStr(std::string("a/"), '/'), "");
+    CU_EXPECT_EQ(CU::SubRePostStr(std::string("a::b::c"), "::"), "c");
+}
+
+CU_TEST(StrPredicates)
+{
+    std::string str("bpf_prog_tracepoint/sched");
+    CU_EXPECT(CU::StrStartsWith(str, "bpf_prog_"));
+    CU_EXPECT(!CU::StrStartsWith(str, "bpf_map_"));
+    CU_EXPECT(!CU::StrStartsWith(std::string("bpf"), "bpf_prog_"));
+    CU_EXPECT(CU::StrEndsWith(str, std::string("sched")));
+    CU_EXPECT(!CU::StrEndsWith(str, ""));
+    CU_EXPECT(CU::StrContains(str, "tracepoint"));
+    CU_EXPECT(!CU::StrContains(str, "kprobe"));
+}
+
+CU_TEST(StrToNumber)
+{
+    CU_EXPECT_EQ(CU::StrToInt("123"), 123);
+    CU_EXPECT_EQ(CU::StrToInt("-42abc"), -42);
+    CU_EXPECT_EQ(CU::StrToInt("99999999999"), INT_MAX);
+    CU_EXPECT_EQ(CU::StrToInt("-99999999999"), INT_MIN);
+    CU_EXPECT_EQ(CU::StrToInt("abc"), 0);
+    CU_EXPECT_EQ(CU::StrToLong("-9000000000"), -9000000000LL);
+    CU_EXPECT_EQ(CU::StrToULong("18446744073709551615"), UINT64_MAX);
+    CU_EXPECT_EQ(CU::HexToInt("ff"), 255);
+    CU_EXPECT_EQ(CU::HexToInt("0x10"), 16);
+    CU_EXPECT(CU::StrToDouble("2.5") == 2.5);
+}
+
+CU_TEST(TrimStr)
+{
+    CU_EXPECT_EQ(CU::TrimStr(" 0-7\n"), "0-7");
+    CU_EXPECT_EQ(CU::TrimStr("\ta b\r\n"), "ab");
+    CU_EXPECT_EQ(CU::TrimStr(""), "");
+}
+
+CU_TEST(NumericHelpers)
+{
+    CU_EXPECT_EQ(CU::Max(3, 9, 1), 9);
+    CU_EXPECT_EQ(CU::Min(3, 9, 1), 1);
+    CU_EXPECT_EQ(CU::Abs(-5), 5);
+    CU_EXPECT_EQ(CU::Round(2.5), 3);
+    CU_EXPECT_EQ(CU::Round(2.4), 2);
+    CU_EXPECT_EQ(CU::Square(7), 49);
+}
+
+CU_TEST(ListHelpers)
+{
+    std::vector<int> list{4, 8, 15, 16, 23, 42};
+    CU_EXPECT(CU::Contains(list, 15));
+    CU_EXPECT(!CU::Contains(list, 7));
+    CU_EXPECT_EQ(CU::ItemPos(list, 16), 3U);
+    CU_EXPECT_EQ(CU::ItemPos(list, 7), static_cast<size_t>(-1));
+    CU_EXPECT_EQ(CU::Sum(list), 108);
+    CU_EXPECT_EQ(CU::Average(list), 18);
+    CU_EXPECT_EQ(*CU::MaxIter(list), 42);
+    CU_EXPECT_EQ(*CU::MinIter(list), 4);
+    CU_EXPECT_EQ(CU::Reverse(list), (std::vector<int>{42, 23, 16, 15, 8, 4}));
+    CU_EXPECT_EQ(CU::Replace(std::string("a/b/c"), '/', '_'), "a_b_c");
+    CU_EXPECT_EQ(CU::CreateVec(1, 2, 3), (std::vector<int>{1, 2, 3}));
+}
+
+CU_TEST(TrimList)
+{
+    std::vector<int> freqs{300, 600, 600, 900, 1200, 1500};
+    CU_EXPECT_EQ(CU::Trim(freqs), (std::vector<int>{300, 600, 900, 1200, 1500}));
+    CU_EXPECT_EQ(CU::Trim(freqs, 10, 500, 1300), (std::vector<int>{600, 900, 1200}));
+    CU_EXPECT_EQ(CU::Trim(freqs, 1, 500, 1300), std::vector<int>{900});
+    CU_EXPECT_EQ(CU::Trim(freqs, 10, 2000, 3000), std::vector<int>{});
+}
+
+CU_TEST_MAIN()